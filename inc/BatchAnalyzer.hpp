@@ -0,0 +1,367 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Batch analysis. Scores many positions at once, each to a
+          fixed depth, and returns every position's score and best
+          move. Made for throughput rather than one strong move: no
+          tree, table, book or time control, a plain alpha-beta per
+          position with PVS, killer and history ordering and a small
+          table per thread. Leaves go to Evaluator::evaluateBatch
+          a group at a time (4 per AVX2 pass), and so do the root's
+          children, which orders the root moves.
+
+          Positions come in as a contiguous array of PackedPosition.
+          A pool of worker threads, started once, takes them in
+          chunks, the caller of analyze() works through the batch
+          too. Scores and rules match a fixed depth alpha-beta
+          OthelloBot search with the same evaluator (no book,
+          endgame solver or selective search); among equal moves the
+          chosen one can differ.
+*/
+
+#pragma once
+
+#include "Board.hpp"
+#include "Evaluator.hpp"
+#include "MoveOrdering.hpp"
+#include "TranspositionTable.hpp"
+#include "PatternEvaluator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+/*
+    Fixed layout position for batches: both colors' bitboards and
+    the side to move (0 black, 1 white)
+*/
+struct PackedPosition {
+    uint64_t black = 0;
+    uint64_t white = 0;
+    uint8_t whiteToMove = 0;
+    uint8_t reserved[7] = {};
+
+    static PackedPosition pack(const Board::Position& pos) {
+        PackedPosition packed;
+        packed.black = pos.black;
+        packed.white = pos.white;
+        packed.whiteToMove = pos.turn == 'w';
+        return packed;
+    }
+
+    Board::Position unpack() const {
+        Board::Position pos;
+        pos.black = black;
+        pos.white = white;
+        pos.turn = whiteToMove ? 'w' : 'b';
+        pos.updateHash();
+        return pos;
+    }
+};
+static_assert(sizeof(PackedPosition) == 24);
+
+class BatchAnalyzer {
+public:
+    struct Result {
+        int move = -1;      // square, -1 for a pass or a finished game
+        int score = 0;      // white - black, like OthelloBot::getLastScore
+    };
+
+    explicit BatchAnalyzer(int depth = 4, int threads = 1,
+                           std::shared_ptr<const Evaluator> evaluator = PatternEvaluator::defaultInstance())
+        : m_depth(std::max(1, depth)), m_evaluator(std::move(evaluator)) {
+        for (int i = 1; i < std::max(1, threads); i++)
+            m_workers.emplace_back([this](std::stop_token shutdown) { run(shutdown); });
+    }
+
+    ~BatchAnalyzer() {
+        for (auto& worker : m_workers) worker.request_stop();
+        m_workers.clear();
+    }
+
+    BatchAnalyzer(const BatchAnalyzer&) = delete;
+    BatchAnalyzer& operator=(const BatchAnalyzer&) = delete;
+
+    void setDepth(int depth) { m_depth = std::max(1, depth); }
+    int getDepth() const { return m_depth; }
+    int getThreads() const { return static_cast<int>(m_workers.size()) + 1; }
+
+    /*
+        Analyze count positions into results (count entries). One
+        batch runs at a time, other callers wait their turn.
+    */
+    void analyze(const PackedPosition* positions, size_t count, Result* results) {
+        if (!count) return;
+        std::lock_guard<std::mutex> serial(m_batchMutex);
+
+        Batch batch{positions, results, count};
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_batch = &batch;
+            m_nodes = 0;
+            m_generation++;
+            m_busy = m_workers.size();
+        }
+        m_ready.notify_all();
+        work(batch);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_busy == 0; });
+        m_batch = nullptr;
+    }
+
+    std::vector<Result> analyze(const std::vector<PackedPosition>& positions) {
+        std::vector<Result> results(positions.size());
+        analyze(positions.data(), positions.size(), results.data());
+        return results;
+    }
+
+    // nodes searched by the last batch, leaves included
+    size_t getNodes() const { return m_nodes; }
+
+private:
+    // positions handed to a thread at a time
+    static constexpr size_t CHUNK = 16;
+
+    // leaves scored per evaluateBatch call, one AVX2 pass
+    static constexpr int GROUP = 4;
+
+    // table per thread, for transpositions within one position's tree
+    static constexpr size_t TT_MB = 1;
+
+    struct Batch {
+        const PackedPosition* positions;
+        Result* results;
+        size_t count;
+        std::atomic<size_t> next = 0;
+    };
+
+    int m_depth;
+    std::shared_ptr<const Evaluator> m_evaluator;
+    std::atomic<size_t> m_nodes = 0;
+
+    std::mutex m_batchMutex;
+    std::mutex m_mutex;
+    std::condition_variable_any m_ready;
+    std::condition_variable m_done;
+    Batch* m_batch = nullptr;
+    uint64_t m_generation = 0;
+    size_t m_busy = 0;
+    std::vector<std::jthread> m_workers;
+
+    void run(std::stop_token shutdown) {
+        uint64_t seen = 0;
+        while (true) {
+            Batch* batch;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (!m_ready.wait(lock, shutdown, [&] { return m_generation != seen; })) return;
+                seen = m_generation;
+                batch = m_batch;
+            }
+            work(*batch);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (--m_busy == 0) m_done.notify_one();
+            }
+        }
+    }
+
+    void work(Batch& batch) {
+        Search search;
+        while (true) {
+            size_t start = batch.next.fetch_add(CHUNK);
+            if (start >= batch.count) break;
+            size_t end = std::min(batch.count, start + CHUNK);
+            for (size_t i = start; i < end; i++) {
+                uint64_t seed = i;
+                search.salt = Zobrist::splitMix64(seed);
+                batch.results[i] = analyzePosition(batch.positions[i].unpack(), search);
+            }
+        }
+        m_nodes += search.nodes;
+    }
+
+    // what one thread keeps while it works through its positions
+    struct Search {
+        MoveOrderer orderer;
+        TranspositionTable tt{TT_MB};
+        uint64_t salt = 0;      // per position, so no entry carries over to the next
+        size_t nodes = 0;
+    };
+
+    Result analyzePosition(Board::Position pos, Search& search) const {
+        Result result;
+        int sign = (pos.turn == 'w') ? 1 : -1;
+        search.orderer.newSearch();
+        if (!pos.legalMoves()) {
+            result.score = sign * negamax(search, pos, m_depth, 0, -INT_MAX, INT_MAX);
+            return result;
+        }
+
+        // the root's children are scored once for ordering, at depth 1
+        // that is the whole search
+        Board::MoveList moves;
+        int scores[PositionBatch::CAPACITY];
+        orderedMoves(pos, moves, scores);
+        search.nodes++;
+        int alpha = scores[0];
+        result.move = moves[0].square;
+        if (m_depth == 1) {
+            search.nodes += moves.size();
+            result.score = sign * alpha;
+            return result;
+        }
+
+        for (int i = 0; i < moves.size(); i++) {
+            pos.makeMove(moves[i]);
+            int value;
+            if (i == 0) value = -negamax(search, pos, m_depth - 1, 1, -INT_MAX, INT_MAX);
+            else {
+                value = -negamax(search, pos, m_depth - 1, 1, -alpha - 1, -alpha);
+                if (value > alpha) value = -negamax(search, pos, m_depth - 1, 1, -INT_MAX, -alpha);
+            }
+            pos.undoMove(moves[i]);
+            if (i == 0 || value > alpha) {
+                alpha = value;
+                result.move = moves[i].square;
+            }
+        }
+        result.score = sign * alpha;
+        return result;
+    }
+
+    // side to move's score, the same depth and pass rules as the bot
+    int negamax(Search& search, Board::Position& pos, int depth, int ply, int alpha, int beta) const {
+        search.nodes++;
+        int sign = (pos.turn == 'w') ? 1 : -1;
+        if (depth == 0) return sign * m_evaluator->evaluate(pos);
+
+        if (!pos.legalMoves()) {
+            if (!pos.mustPass()) return sign * pos.finalScore();
+            pos.pass();
+            int value = -negamax(search, pos, depth, ply + 1, -beta, -alpha);
+            pos.pass();
+            return value;
+        }
+
+        Board::MoveList moves;
+        if (depth == 1) {
+            pos.generateMoves(moves);
+            search.orderer.order(moves, pos, ply, depth, -1, -1);
+            return frontier(search, pos, moves, ply, beta);
+        }
+
+        // stored results only count at the same depth, to keep the
+        // score that of a plain fixed depth search
+        uint64_t key = pos.hash ^ search.salt;
+        int alphaOrig = alpha;
+        int hashMove = -1;
+        TTEntry entry;
+        if (search.tt.probe(key, entry)) {
+            hashMove = entry.bestMove;
+            if (entry.depth == depth) {
+                if (entry.bound == Bound::EXACT) return entry.score;
+                if (entry.bound == Bound::LOWER && entry.score >= beta) return entry.score;
+                if (entry.bound == Bound::UPPER && entry.score <= alpha) return entry.score;
+            }
+        }
+
+        pos.generateMoves(moves);
+        search.orderer.order(moves, pos, ply, depth, -1, hashMove);
+        int best = -INT_MAX;
+        int bestMove = -1;
+        for (int i = 0; i < moves.size(); i++) {
+            pos.makeMove(moves[i]);
+            int value;
+            if (i == 0) value = -negamax(search, pos, depth - 1, ply + 1, -beta, -alpha);
+            else {
+                // null window first, a move that beats alpha is searched again
+                value = -negamax(search, pos, depth - 1, ply + 1, -alpha - 1, -alpha);
+                if (value > alpha && value < beta) value = -negamax(search, pos, depth - 1, ply + 1, -beta, -alpha);
+            }
+            pos.undoMove(moves[i]);
+            if (value > best) {
+                best = value;
+                bestMove = moves[i].square;
+            }
+            alpha = std::max(alpha, value);
+            if (alpha >= beta) {
+                search.orderer.recordCutoff(pos, moves[i].square, ply, depth, i);
+                break;
+            }
+        }
+
+        Bound bound = best <= alphaOrig ? Bound::UPPER : best >= beta ? Bound::LOWER : Bound::EXACT;
+        search.tt.store(key, depth, bound, best, bestMove);
+        return best;
+    }
+
+    /*
+        A node whose children are leaves. Most cutoffs come on the
+        first move, so it is scored alone, the rest a SIMD group at
+        a time, so a later cutoff still saves what is left.
+    */
+    int frontier(Search& search, const Board::Position& pos, const Board::MoveList& moves, int ply, int beta) const {
+        int sign = (pos.turn == 'w') ? 1 : -1;
+        int best = -INT_MAX;
+        PositionBatch group;
+        int scores[GROUP];
+        for (int first = 0, last = 1; first < moves.size(); first = last, last = std::min(moves.size(), last + GROUP)) {
+            pushChildren(pos, moves, first, last, group);
+            m_evaluator->evaluateBatch(group, scores);
+            search.nodes += group.count;
+
+            for (int i = 0; i < group.count; i++) {
+                best = std::max(best, sign * scores[i]);
+                if (best >= beta) {
+                    search.orderer.recordCutoff(pos, moves[first + i].square, ply, 1, first + i);
+                    return best;
+                }
+            }
+        }
+        return best;
+    }
+
+    // the position after each move, without a hash: only evaluated
+    static void pushChildren(const Board::Position& pos, const Board::MoveList& moves, int first, int last, PositionBatch& children) {
+        children.clear();
+        char next = (pos.turn == 'b') ? 'w' : 'b';
+        for (int m = first; m < last; m++) {
+            const Board::Move& move = moves[m];
+            Board::Bitboard placed = Board::squareBit(move.square) | move.flips;
+            int i = children.count++;
+            children.black[i] = (pos.turn == 'b') ? pos.black | placed : pos.black & ~move.flips;
+            children.white[i] = (pos.turn == 'w') ? pos.white | placed : pos.white & ~move.flips;
+            children.turn[i] = next;
+        }
+    }
+
+    // legal moves and their static scores for the side to move, best first
+    void orderedMoves(const Board::Position& pos, Board::MoveList& moves, int* scores) const {
+        pos.generateMoves(moves);
+        PositionBatch children;
+        pushChildren(pos, moves, 0, moves.size(), children);
+        m_evaluator->evaluateBatch(children, scores);
+
+        int sign = (pos.turn == 'w') ? 1 : -1;
+        for (int i = 0; i < moves.size(); i++) scores[i] *= sign;
+        for (int i = 1; i < moves.size(); i++) {
+            Board::Move move = moves[i];
+            int score = scores[i];
+            int j = i;
+            for (; j > 0 && scores[j - 1] < score; j--) {
+                moves[j] = moves[j - 1];
+                scores[j] = scores[j - 1];
+            }
+            moves[j] = move;
+            scores[j] = score;
+        }
+    }
+};
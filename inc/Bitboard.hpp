@@ -0,0 +1,298 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Bitboard position type. The board is held as two 64-bit
+          masks (one per color) and moves are generated and resolved
+          with shift-and-mask operations. Square index is row * 8 + col.
+          generateMoves and computeFlips use the AVX2 kernels of
+          BitboardAvx2.hpp when the CPU has AVX2, the scalar shifts
+          below otherwise.
+          Each position carries its Zobrist hash, kept up to date by
+          makeMove/undoMove.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <bit>
+
+#include "Zobrist.hpp"
+#include "BitboardAvx2.hpp"
+
+namespace Board {
+
+using Bitboard = uint64_t;
+
+constexpr Bitboard NOT_COL_0 = 0xfefefefefefefefeULL;
+constexpr Bitboard NOT_COL_7 = 0x7f7f7f7f7f7f7f7fULL;
+
+inline int squareIndex(int row, int col) { return row * 8 + col; }
+inline Bitboard squareBit(int square) { return 1ULL << square; }
+
+template <int Dir>
+inline Bitboard shift(Bitboard b) {
+    /*
+        Move every bit one step in a direction. Masks stop pieces
+        from wrapping around from one edge of the board to the other.
+    */
+    if constexpr (Dir == 1)  return (b << 1) & NOT_COL_0;
+    if constexpr (Dir == -1) return (b >> 1) & NOT_COL_7;
+    if constexpr (Dir == 8)  return b << 8;
+    if constexpr (Dir == -8) return b >> 8;
+    if constexpr (Dir == 9)  return (b << 9) & NOT_COL_0;
+    if constexpr (Dir == -9) return (b >> 9) & NOT_COL_7;
+    if constexpr (Dir == 7)  return (b << 7) & NOT_COL_7;
+    if constexpr (Dir == -7) return (b >> 7) & NOT_COL_0;
+    return 0;
+}
+
+template <int Dir>
+inline Bitboard movesInDirection(Bitboard player, Bitboard opponent, Bitboard empty) {
+    /*
+        Flood from the player's pieces through runs of opponent pieces.
+        A run is at most 6 long, so 6 steps reach every possible end.
+    */
+    Bitboard x = shift<Dir>(player) & opponent;
+    x |= shift<Dir>(x) & opponent;
+    x |= shift<Dir>(x) & opponent;
+    x |= shift<Dir>(x) & opponent;
+    x |= shift<Dir>(x) & opponent;
+    x |= shift<Dir>(x) & opponent;
+    return shift<Dir>(x) & empty;
+}
+
+template <int Dir>
+inline Bitboard flipsInDirection(Bitboard move, Bitboard player, Bitboard opponent) {
+    /*
+        Walk from the placed piece over opponent pieces. The run only
+        flips if it is capped by one of the player's pieces.
+    */
+    Bitboard flips = 0;
+    Bitboard x = shift<Dir>(move);
+    while (x & opponent) {
+        flips |= x;
+        x = shift<Dir>(x);
+    }
+    return (x & player) ? flips : 0;
+}
+
+inline Bitboard generateMovesScalar(Bitboard player, Bitboard opponent) {
+    /*
+        Every empty square that captures in at least one direction
+    */
+    Bitboard empty = ~(player | opponent);
+    return movesInDirection<1>(player, opponent, empty)
+         | movesInDirection<-1>(player, opponent, empty)
+         | movesInDirection<8>(player, opponent, empty)
+         | movesInDirection<-8>(player, opponent, empty)
+         | movesInDirection<9>(player, opponent, empty)
+         | movesInDirection<-9>(player, opponent, empty)
+         | movesInDirection<7>(player, opponent, empty)
+         | movesInDirection<-7>(player, opponent, empty);
+}
+
+inline Bitboard computeFlipsScalar(int square, Bitboard player, Bitboard opponent) {
+    /*
+        Opponent pieces flipped by the player placing on square.
+        Returns 0 if the move captures nothing.
+    */
+    Bitboard move = squareBit(square);
+    return flipsInDirection<1>(move, player, opponent)
+         | flipsInDirection<-1>(move, player, opponent)
+         | flipsInDirection<8>(move, player, opponent)
+         | flipsInDirection<-8>(move, player, opponent)
+         | flipsInDirection<9>(move, player, opponent)
+         | flipsInDirection<-9>(move, player, opponent)
+         | flipsInDirection<7>(move, player, opponent)
+         | flipsInDirection<-7>(move, player, opponent);
+}
+
+// picked once at startup from the CPU, setAvx2 can turn it off
+inline bool useAvx2 = cpuHasAvx2();
+
+// returns whether the AVX2 kernels are now in use
+inline bool setAvx2(bool on) {
+    useAvx2 = on && cpuHasAvx2();
+    return useAvx2;
+}
+
+inline Bitboard generateMoves(Bitboard player, Bitboard opponent) {
+#if BOARD_AVX2
+    if (useAvx2) return generateMovesAvx2(player, opponent);
+#endif
+    return generateMovesScalar(player, opponent);
+}
+
+inline Bitboard computeFlips(int square, Bitboard player, Bitboard opponent) {
+#if BOARD_AVX2
+    if (useAvx2) return computeFlipsAvx2(square, player, opponent);
+#endif
+    return computeFlipsScalar(square, player, opponent);
+}
+
+inline Bitboard flipVertical(Bitboard b) { return std::byteswap(b); }
+
+inline Bitboard mirrorHorizontal(Bitboard b) {
+    b = ((b >> 1) & 0x5555555555555555ULL) | ((b & 0x5555555555555555ULL) << 1);
+    b = ((b >> 2) & 0x3333333333333333ULL) | ((b & 0x3333333333333333ULL) << 2);
+    return ((b >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((b & 0x0f0f0f0f0f0f0f0fULL) << 4);
+}
+
+inline Bitboard transpose(Bitboard b) {
+    // swap (row, col) for (col, row), the a1-h8 diagonal stays put
+    Bitboard t;
+    t = 0x0f0f0f0f00000000ULL & (b ^ (b << 28)); b ^= t ^ (t >> 28);
+    t = 0x3333000033330000ULL & (b ^ (b << 14)); b ^= t ^ (t >> 14);
+    t = 0x5500550055005500ULL & (b ^ (b << 7));  b ^= t ^ (t >> 7);
+    return b;
+}
+
+constexpr int SYMMETRIES = 8;
+
+/*
+    One of the 8 symmetries of the board, 0 is the identity. Bit 0
+    flips the rows, bit 1 mirrors the columns, bit 2 then transposes.
+*/
+inline Bitboard symmetry(Bitboard b, int s) {
+    if (s & 1) b = flipVertical(b);
+    if (s & 2) b = mirrorHorizontal(b);
+    if (s & 4) b = transpose(b);
+    return b;
+}
+
+struct Move {
+    int square;
+    Bitboard flips;
+
+    int row() const { return square / 8; }
+    int col() const { return square % 8; }
+};
+
+// one slot per square, so any position (reachable or not) fits
+constexpr int MAX_MOVES = 64;
+
+struct MoveList {
+    Move moves[MAX_MOVES];
+    int count = 0;
+
+    void clear() { count = 0; }
+    void push(int square, Bitboard flips) { moves[count++] = {square, flips}; }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Move* begin() { return moves; }
+    Move* end() { return moves + count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+
+    Move& operator[](int i) { return moves[i]; }
+    const Move& operator[](int i) const { return moves[i]; }
+
+    const Move* find(int square) const {
+        for (int i = 0; i < count; i++)
+            if (moves[i].square == square)
+                return &moves[i];
+        return nullptr;
+    }
+};
+
+struct Position {
+    Bitboard black = 0;
+    Bitboard white = 0;
+    char turn = 'b';
+    uint64_t hash = 0;
+
+    Position() { clear(); }
+
+    void clear() {
+        black = squareBit(squareIndex(3, 4)) | squareBit(squareIndex(4, 3));
+        white = squareBit(squareIndex(3, 3)) | squareBit(squareIndex(4, 4));
+        turn = 'b';
+        updateHash();
+    }
+
+    void updateHash() { hash = Zobrist::hash(black, white, turn); }
+
+    Bitboard player() const { return turn == 'b' ? black : white; }
+    Bitboard opponent() const { return turn == 'b' ? white : black; }
+    Bitboard empty() const { return ~(black | white); }
+
+    int blackCount() const { return std::popcount(black); }
+    int whiteCount() const { return std::popcount(white); }
+
+    Bitboard legalMoves() const { return Board::generateMoves(player(), opponent()); }
+
+    // no move here, but the opponent has one
+    bool mustPass() const { return !legalMoves() && Board::generateMoves(opponent(), player()); }
+    bool isGameOver() const { return !legalMoves() && !Board::generateMoves(opponent(), player()); }
+
+    // score of a finished game, white - black, empty squares go to the winner
+    int finalScore() const {
+        int diff = whiteCount() - blackCount();
+        int empties = std::popcount(empty());
+        return diff > 0 ? diff + empties : diff < 0 ? diff - empties : 0;
+    }
+
+    Bitboard flips(int square) const { return computeFlips(square, player(), opponent()); }
+
+    void generateMoves(MoveList& list) const {
+        /*
+            Fill list with every legal move and its flip mask
+        */
+        list.clear();
+        Bitboard moves = legalMoves();
+        while (moves) {
+            int square = std::countr_zero(moves);
+            moves &= moves - 1;
+            list.push(square, flips(square));
+        }
+    }
+
+    void play(int square, Bitboard flipped) {
+        /*
+            Place the current player's piece, flip the captured
+            pieces and hand the turn to the opponent
+        */
+        Bitboard placed = squareBit(square) | flipped;
+        hash ^= Zobrist::moveDelta(turn == 'b' ? 0 : 1, square, flipped);
+        if (turn == 'b') {
+            black |= placed;
+            white &= ~flipped;
+        } else {
+            white |= placed;
+            black &= ~flipped;
+        }
+        turn = (turn == 'b') ? 'w' : 'b';
+    }
+
+    void makeMove(const Move& move) { play(move.square, move.flips); }
+
+    void pass() {
+        /*
+            The player on turn has no move and hands the turn over.
+            Its own inverse.
+        */
+        hash ^= Zobrist::KEYS.whiteToMove;
+        turn = (turn == 'b') ? 'w' : 'b';
+    }
+
+    void undoMove(const Move& move) {
+        /*
+            Exact inverse of makeMove. The mover is the side that
+            is not on turn, take back its piece and the flips.
+        */
+        turn = (turn == 'b') ? 'w' : 'b';
+        Bitboard placed = squareBit(move.square) | move.flips;
+        hash ^= Zobrist::moveDelta(turn == 'b' ? 0 : 1, move.square, move.flips);
+        if (turn == 'b') {
+            black ^= placed;
+            white |= move.flips;
+        } else {
+            white ^= placed;
+            black |= move.flips;
+        }
+    }
+};
+
+}
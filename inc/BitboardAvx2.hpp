@@ -0,0 +1,115 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: AVX2 move generation. The 8 directions are split into 4
+          lanes (1, 8, 9, 7 squares), each lane walked both ways at
+          once with variable 64-bit shifts. Runs of opponent pieces
+          are filled Kogge-Stone style: one step, then two doubled
+          steps reach the longest run of 6.
+
+          The kernels are compiled for AVX2 with a target attribute,
+          so the rest of the engine needs no -mavx2. Bitboard.hpp
+          calls them only when the CPU has AVX2 (see setAvx2) and
+          falls back to the scalar shifts otherwise, or on compilers
+          and targets without these intrinsics (BOARD_AVX2 is 0).
+          Other AVX2 code marks its functions BOARD_AVX2_TARGET.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BOARD_AVX2 1
+#include <immintrin.h>
+#else
+#define BOARD_AVX2 0
+#endif
+
+namespace Board {
+
+#if BOARD_AVX2
+
+#define BOARD_AVX2_TARGET __attribute__((target("avx2")))
+
+inline bool cpuHasAvx2() { return __builtin_cpu_supports("avx2"); }
+
+namespace Avx2 {
+
+/*
+    Lane i walks steps() squares towards h8 (left shifts) and
+    towards a1 (right shifts). Opponent pieces on the edges a run
+    can't pass through are masked off, which also keeps runs from
+    wrapping around the board.
+*/
+BOARD_AVX2_TARGET inline __m256i steps() { return _mm256_set_epi64x(7, 9, 8, 1); }
+
+BOARD_AVX2_TARGET inline __m256i interior(uint64_t opponent) {
+    return _mm256_and_si256(_mm256_set1_epi64x(static_cast<long long>(opponent)),
+                            _mm256_set_epi64x(0x007e7e7e7e7e7e00LL, 0x007e7e7e7e7e7e00LL,
+                                              0x00ffffffffffff00LL, 0x7e7e7e7e7e7e7e7eLL));
+}
+
+BOARD_AVX2_TARGET inline uint64_t orLanes(__m256i v) {
+    __m128i x = _mm_or_si128(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    x = _mm_or_si128(x, _mm_unpackhi_epi64(x, x));
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(x));
+}
+
+// opponent runs that start next to seeds, towards h8 and towards a1
+BOARD_AVX2_TARGET inline void fill(__m256i seeds, __m256i opponent, __m256i& up, __m256i& down) {
+    const __m256i step = steps();
+    const __m256i step2 = _mm256_add_epi64(step, step);
+
+    up = _mm256_and_si256(opponent, _mm256_sllv_epi64(seeds, step));
+    down = _mm256_and_si256(opponent, _mm256_srlv_epi64(seeds, step));
+    up = _mm256_or_si256(up, _mm256_and_si256(opponent, _mm256_sllv_epi64(up, step)));
+    down = _mm256_or_si256(down, _mm256_and_si256(opponent, _mm256_srlv_epi64(down, step)));
+
+    // pairs of opponent pieces, so the run can grow two squares a step
+    __m256i pairsUp = _mm256_and_si256(opponent, _mm256_sllv_epi64(opponent, step));
+    __m256i pairsDown = _mm256_srlv_epi64(pairsUp, step);
+    up = _mm256_or_si256(up, _mm256_and_si256(pairsUp, _mm256_sllv_epi64(up, step2)));
+    down = _mm256_or_si256(down, _mm256_and_si256(pairsDown, _mm256_srlv_epi64(down, step2)));
+    up = _mm256_or_si256(up, _mm256_and_si256(pairsUp, _mm256_sllv_epi64(up, step2)));
+    down = _mm256_or_si256(down, _mm256_and_si256(pairsDown, _mm256_srlv_epi64(down, step2)));
+}
+
+}
+
+BOARD_AVX2_TARGET inline uint64_t generateMovesAvx2(uint64_t player, uint64_t opponent) {
+    /*
+        Every empty square one step past a run that starts next to
+        one of the player's pieces
+    */
+    __m256i up, down;
+    Avx2::fill(_mm256_set1_epi64x(static_cast<long long>(player)), Avx2::interior(opponent), up, down);
+    const __m256i step = Avx2::steps();
+    __m256i moves = _mm256_or_si256(_mm256_sllv_epi64(up, step), _mm256_srlv_epi64(down, step));
+    return Avx2::orLanes(moves) & ~(player | opponent);
+}
+
+BOARD_AVX2_TARGET inline uint64_t computeFlipsAvx2(int square, uint64_t player, uint64_t opponent) {
+    /*
+        Runs out from the placed piece in all 8 directions. A lane
+        keeps its run only if a player piece caps it.
+    */
+    __m256i up, down;
+    Avx2::fill(_mm256_set1_epi64x(static_cast<long long>(1ULL << square)), Avx2::interior(opponent), up, down);
+    const __m256i step = Avx2::steps();
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i playerLanes = _mm256_set1_epi64x(static_cast<long long>(player));
+
+    __m256i openUp = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_sllv_epi64(up, step), playerLanes), zero);
+    __m256i openDown = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_srlv_epi64(down, step), playerLanes), zero);
+    __m256i flips = _mm256_or_si256(_mm256_andnot_si256(openUp, up), _mm256_andnot_si256(openDown, down));
+    return Avx2::orLanes(flips);
+}
+
+#else
+
+inline bool cpuHasAvx2() { return false; }
+
+#endif
+
+}
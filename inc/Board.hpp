@@ -8,28 +8,28 @@
 
 #pragma once
 
-#include <vector>
-#include <unordered_map>
 #include <string>
 #include <iostream>
+#include <cctype>
+
+#include "Bitboard.hpp"
 
 namespace Board {
 
 struct State;
-bool checkVertical(int row, int col, State& state);
-bool checkHorizontal(int row, int col, State& state);
-bool checkDiagonal(int row, int col, State& state);
-bool isValidMove(int row, int col, State& state);
-State resolve(int row, int col, State& state);
-void updateScore(State& state);
-bool isGameOver(State& state);
+inline Position toPosition(const State& state);
+inline void fromPosition(State& state, const Position& pos);
+inline bool isValidMove(int row, int col, State& state);
+inline State resolve(int row, int col, State& state);
+inline void updateScore(State& state);
+inline bool isGameOver(State& state);
 
 struct State {
     char board[8][8];
     char turn = 'b';
     int white = 2;
     int black = 2;
-    std::unordered_map<std::string, State> possibleStates;
+    MoveList moves;
 
     State() { clear(); }
 
@@ -44,140 +44,86 @@ struct State {
         board[4][4] = 'w';
 
         turn = 'b';
+        moves.clear();
     }
 
-    void updatePossibleStates() {
-        possibleStates.clear();
-        
-        for (int row = 0; row < 8; row++) {
-            for (int col = 0; col < 8; col++) {
-                if (isValidMove(row, col, *this)) {
-                    State newState = resolve(row, col, *this);
-                    newState.turn = (turn == 'b') ? 'w' : 'b';
-                    updateScore(newState);
-                    std::string key = std::to_string(row) + ":" + std::to_string(col);
-                    possibleStates[key] = newState;
-                }
-            }
-        }
+    void updateMoves() {
+        toPosition(*this).generateMoves(moves);
     }
-    
-    void place(int row, int col) {
-        std::string key = std::to_string(row) + ":" + std::to_string(col);
-        if (possibleStates.find(key) != possibleStates.end())
-            *this = possibleStates[key];
+
+    const Move* findMove(int row, int col) const {
+        if (row < 0 || row >= 8 || col < 0 || col >= 8)
+            return nullptr;
+        return moves.find(squareIndex(row, col));
     }
-};
 
-bool checkVertical(int row, int col, State& state) {
-    /*
-        Shoot a "ray" upwards and downwards. Check for collision with
-        a current turn piece. Then check if there are opponent pieces
-        in between. Return true if both are true.
-    */
-    if (state.board[row][col] != ' ') return false;
-    
-    char currentPlayer = state.turn;
-    char opponent = (currentPlayer == 'b') ? 'w' : 'b';
-    bool foundCapture = false;
-    
-    int tempRow = row - 1;
-    bool hasOpponentBetween = false;
-    while (tempRow >= 0 && state.board[tempRow][col] == opponent) {
-        hasOpponentBetween = true;
-        tempRow--;
+    void play(const Move& move) {
+        Position pos = toPosition(*this);
+        pos.makeMove(move);
+        fromPosition(*this, pos);
     }
-    if (hasOpponentBetween && tempRow >= 0 && state.board[tempRow][col] == currentPlayer)
-        foundCapture = true;
     
-    tempRow = row + 1;
-    hasOpponentBetween = false;
-    while (tempRow < 8 && state.board[tempRow][col] == opponent) {
-        hasOpponentBetween = true;
-        tempRow++;
+    void place(int row, int col) {
+        if (const Move* move = findMove(row, col))
+            play(*move);
     }
-    if (hasOpponentBetween && tempRow < 8 && state.board[tempRow][col] == currentPlayer)
-        foundCapture = true;
     
-    return foundCapture;
+    void pass() {
+        /*
+            Hand the turn over, for when the side to move has no
+            move but the opponent does
+        */
+        turn = (turn == 'b') ? 'w' : 'b';
+        updateMoves();
+    }
+};
+
+inline std::string moveKey(int row, int col) {
+    return std::to_string(row) + ":" + std::to_string(col);
 }
 
-bool checkHorizontal(int row, int col, State& state) {
+inline Position toPosition(const State& state) {
     /*
-        Shoot a "ray" left and right. Check for collision with
-        a current turn piece. Then check if there are opponent pieces
-        in between. Return true if both are true.
+        Pack the char board into black and white bitboards
     */
-    if (state.board[row][col] != ' ') return false;
-    
-    char currentPlayer = state.turn;
-    char opponent = (currentPlayer == 'b') ? 'w' : 'b';
-    bool foundCapture = false;
+    Position pos;
+    pos.black = 0;
+    pos.white = 0;
+    pos.turn = state.turn;
     
-    int tempCol = col - 1;
-    bool hasOpponentBetween = false;
-    while (tempCol >= 0 && state.board[row][tempCol] == opponent) {
-        hasOpponentBetween = true;
-        tempCol--;
-    }
-    if (hasOpponentBetween && tempCol >= 0 && state.board[row][tempCol] == currentPlayer)
-        foundCapture = true;
-    
-    tempCol = col + 1;
-    hasOpponentBetween = false;
-    while (tempCol < 8 && state.board[row][tempCol] == opponent) {
-        hasOpponentBetween = true;
-        tempCol++;
-    }
-    if (hasOpponentBetween && tempCol < 8 && state.board[row][tempCol] == currentPlayer)
-        foundCapture = true;
+    for (int row = 0; row < 8; row++)
+        for (int col = 0; col < 8; col++)
+            if (state.board[row][col] == 'b')
+                pos.black |= squareBit(squareIndex(row, col));
+            else if (state.board[row][col] == 'w')
+                pos.white |= squareBit(squareIndex(row, col));
     
-    return foundCapture;
+    pos.updateHash();
+    return pos;
 }
 
-bool checkDiagonal(int row, int col, State& state) {
+inline void fromPosition(State& state, const Position& pos) {
     /*
-        Shoot a "ray" in all 4 diagonal directions. Check for collision with
-        a current turn piece. Then check if there are opponent pieces
-        in between. Return true if both are true.
+        Unpack bitboards back into the char board used for rendering.
+        Clears the cached move list, it belongs to the old board.
     */
-    if (state.board[row][col] != ' ') return false;
-    
-    char currentPlayer = state.turn;
-    char opponent = (currentPlayer == 'b') ? 'w' : 'b';
-    bool foundCapture = false;
-    
-    int directions[4][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
-    
-    for (int dir = 0; dir < 4; dir++) {
-        int rowDir = directions[dir][0];
-        int colDir = directions[dir][1];
-        
-        int tempRow = row + rowDir;
-        int tempCol = col + colDir;
-        bool hasOpponentBetween = false;
-        
-        while (tempRow >= 0 && tempRow < 8 && tempCol >= 0 && tempCol < 8 && 
-               state.board[tempRow][tempCol] == opponent) {
-            hasOpponentBetween = true;
-            tempRow += rowDir;
-            tempCol += colDir;
-        }
-        
-        if (hasOpponentBetween && tempRow >= 0 && tempRow < 8 && tempCol >= 0 && tempCol < 8 && 
-            state.board[tempRow][tempCol] == currentPlayer) {
-            foundCapture = true;
-            break;
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            Bitboard bit = squareBit(squareIndex(row, col));
+            state.board[row][col] = (pos.black & bit) ? 'b' : (pos.white & bit) ? 'w' : ' ';
         }
     }
     
-    return foundCapture;
+    state.turn = pos.turn;
+    state.white = pos.whiteCount();
+    state.black = pos.blackCount();
+    state.moves.clear();
 }
 
-bool isValidMove(int row, int col, State& state) {
+inline bool isValidMove(int row, int col, State& state) {
     /*
-        Check all directions. Return true if it is a valid position
-        for any of the directions.
+        Check all directions at once on the bitboard. Return true if
+        the square is in the current player's legal move mask.
     */
     if (row < 0 || row >= 8 || col < 0 || col >= 8)
         return false;
@@ -185,12 +131,10 @@ bool isValidMove(int row, int col, State& state) {
     if (state.board[row][col] != ' ')
         return false;
     
-    return checkVertical(row, col, state) || 
-           checkHorizontal(row, col, state) || 
-           checkDiagonal(row, col, state);
+    return toPosition(state).legalMoves() & squareBit(squareIndex(row, col));
 }
 
-void printState(State& state) {
+inline void printState(State& state) {
     /*
         Print a nicely formatted board state in terminal
     */
@@ -207,78 +151,112 @@ void printState(State& state) {
     }
 }
 
-State resolve(int row, int col, State& state) {
+inline State resolve(int row, int col, State& state) {
     /*
-        
+        Place a piece for the current turn and flip every captured
+        opponent piece. Returns the state unchanged if the move is invalid.
     */
     if (!isValidMove(row, col, state))
         return state;
     
-    State newState = state;
-    newState.possibleStates.clear();
-    newState.board[row][col] = state.turn;
-    
-    char currentPlayer = state.turn;
-    char opponent = (currentPlayer == 'b') ? 'w' : 'b';
-    
-    int directions[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
+    Position pos = toPosition(state);
+    int square = squareIndex(row, col);
+    pos.play(square, pos.flips(square));
     
-    for (int dir = 0; dir < 8; dir++) {
-        int rowDir = directions[dir][0];
-        int colDir = directions[dir][1];
-        
-        int tempRow = row + rowDir;
-        int tempCol = col + colDir;
-        std::vector<std::pair<int, int>> toFlip;
-        
-        while (tempRow >= 0 && tempRow < 8 && tempCol >= 0 && tempCol < 8 && 
-               newState.board[tempRow][tempCol] == opponent) {
-            toFlip.push_back({tempRow, tempCol});
-            tempRow += rowDir;
-            tempCol += colDir;
-        }
-        
-        if (!toFlip.empty() && tempRow >= 0 && tempRow < 8 && tempCol >= 0 && tempCol < 8 && 
-            newState.board[tempRow][tempCol] == currentPlayer) {
-            for (auto& pos : toFlip)
-                newState.board[pos.first][pos.second] = currentPlayer;
-        }
-    }
-    
-    newState.turn = opponent;
+    State newState;
+    fromPosition(newState, pos);
     return newState;
 }
 
-void updateScore(State& state) {
+inline void updateScore(State& state) {
     /*
         Count each white and black piece currently on a board.
         Update the State's white and black counts.
     */
-    state.white = 0;
-    state.black = 0;
-    
-    for (int row = 0; row < 8; row++)
-        for (int col = 0; col < 8; col++)
-            if (state.board[row][col] == 'w')
-                state.white++;
-            else if (state.board[row][col] == 'b')
-                state.black++;
+    Position pos = toPosition(state);
+    state.white = pos.whiteCount();
+    state.black = pos.blackCount();
 }
 
-bool isGameOver(State& state) {
+inline bool isGameOver(State& state) {
     /*
         Check if there are any possible moves for the current turn.
         If not, game has ended.
     */
-    state.updatePossibleStates();
-    if (!state.possibleStates.empty())
+    state.updateMoves();
+    if (!state.moves.empty())
         return false;
     
-    State tempState = state;
-    tempState.turn = (state.turn == 'b') ? 'w' : 'b';
-    tempState.updatePossibleStates();
+    Position pos = toPosition(state);
+    pos.turn = (state.turn == 'b') ? 'w' : 'b';
+    
+    return pos.legalMoves() == 0;
+}
+
+inline std::string squareName(int square) {
+    /*
+        Board notation as printed by printState: column letter,
+        then row number from 1. Square 19 (row 2, col 3) is "d3".
+    */
+    if (square < 0 || square >= 64) return "pass";
+    return std::string(1, static_cast<char>('a' + square % 8)) + std::to_string(square / 8 + 1);
+}
+
+inline int parseSquare(const std::string& text) {
+    /*
+        Inverse of squareName, either letter case. Returns -1 if
+        text is not a square.
+    */
+    if (text.size() != 2) return -1;
+    int col = std::tolower(static_cast<unsigned char>(text[0])) - 'a';
+    int row = text[1] - '1';
+    if (col < 0 || col >= 8 || row < 0 || row >= 8) return -1;
+    return squareIndex(row, col);
+}
+
+inline std::string toString(const Position& pos) {
+    /*
+        One line text form: 64 squares in row order ('X' black,
+        'O' white, '-' empty), a space, then the side to move
+    */
+    std::string text;
+    for (int square = 0; square < 64; square++) {
+        Bitboard bit = squareBit(square);
+        text += (pos.black & bit) ? 'X' : (pos.white & bit) ? 'O' : '-';
+    }
+    text += ' ';
+    text += (pos.turn == 'b') ? 'X' : 'O';
+    return text;
+}
+
+inline bool parsePosition(const std::string& text, Position& pos) {
+    /*
+        Read the toString form. 'b'/'w' and '.' are also accepted
+        for pieces and empty squares. Whitespace between the board
+        and the side to move is skipped. Returns false on bad input.
+    */
+    Bitboard black = 0, white = 0;
+    size_t i = 0;
+    for (int square = 0; square < 64; square++, i++) {
+        if (i >= text.size()) return false;
+        char c = static_cast<char>(std::toupper(static_cast<unsigned char>(text[i])));
+        if (c == 'X' || c == 'B') black |= squareBit(square);
+        else if (c == 'O' || c == 'W') white |= squareBit(square);
+        else if (c != '-' && c != '.') return false;
+    }
+    
+    while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) i++;
+    if (i >= text.size()) return false;
+    
+    char side = static_cast<char>(std::toupper(static_cast<unsigned char>(text[i])));
+    if (side == 'X' || side == 'B') pos.turn = 'b';
+    else if (side == 'O' || side == 'W') pos.turn = 'w';
+    else return false;
     
-    return tempState.possibleStates.empty();
+    pos.black = black;
+    pos.white = white;
+    pos.updateHash();
+    return true;
 }
 
 }
\ No newline at end of file
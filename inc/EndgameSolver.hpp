@@ -0,0 +1,313 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Exact endgame solver. Searches to the end of the game and
+          returns the final disc differential for the side to move,
+          empty squares going to the winner. Negamax with null-window
+          (PVS) searches. Moves are ordered fastest-first (fewest
+          opponent replies) above SHALLOW_EMPTIES, where a hash table
+          is used, and by quadrant parity below it, where the search
+          runs straight off the empty-square mask with no move list.
+*/
+
+#pragma once
+
+#include "Bitboard.hpp"
+#include "TranspositionTable.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+class EndgameSolver {
+public:
+    // empties at or below which the bot hands over to the solver
+    static constexpr int DEFAULT_EMPTIES = 14;
+
+    // below this many empties: no hash table, no move list, parity order
+    static constexpr int SHALLOW_EMPTIES = 6;
+
+    // scores are within [-64, 64]
+    static constexpr int SCORE_MAX = 64;
+
+    struct Result {
+        int move = -1;          // square, -1 for a pass or a finished game
+        int score = 0;          // final discs, side to move minus opponent
+        size_t nodes = 0;
+        bool solved = false;    // false if the time budget ran out
+    };
+
+    EndgameSolver(size_t hashMB = 16) : m_tt(hashMB) {}
+
+    void setHashSize(size_t megabytes) { m_tt.resize(megabytes); }
+    void clearHash() { m_tt.clear(); }
+
+    // the solver gives up, like on a timeout, once *stop is set
+    void setStopFlag(const std::atomic<bool>* stop) { m_stop = stop; }
+
+    /*
+        Solve pos exactly. With a budget, gives up (solved = false)
+        once it runs out or the stop flag is set, the result is then
+        meaningless.
+    */
+    Result solve(const Board::Position& pos, int timeBudgetMs = 0) {
+        m_nodes = 0;
+        m_aborted = false;
+        m_timeBudgetMs = timeBudgetMs;
+        m_start = std::chrono::steady_clock::now();
+        m_tt.newSearch();
+
+        Result result;
+        Board::Bitboard player = pos.player(), opponent = pos.opponent();
+        int empties = std::popcount(pos.empty());
+
+        // no move at the root: pass, or the game is already over
+        if (!Board::generateMoves(player, opponent)) {
+            result.score = search(player, opponent, -SCORE_MAX - 1, SCORE_MAX + 1, empties, false);
+            result.nodes = m_nodes;
+            result.solved = !m_aborted;
+            return result;
+        }
+
+        SortedMoves moves;
+        orderMoves(moves, player, opponent, -1);
+
+        /*
+            The first move gets the full window. The others only
+            have to be shown no better with a null window, and are
+            searched again for their exact value when they are.
+        */
+        int alpha = -SCORE_MAX - 1, beta = SCORE_MAX + 1;
+        for (int i = 0; i < moves.count; i++) {
+            auto [square, flips] = moves.moves[i];
+            Board::Bitboard nextPlayer = opponent & ~flips;
+            Board::Bitboard nextOpponent = player | flips | Board::squareBit(square);
+
+            int score;
+            if (i == 0) score = -search(nextPlayer, nextOpponent, -beta, -alpha, empties - 1, false);
+            else {
+                score = -search(nextPlayer, nextOpponent, -alpha - 1, -alpha, empties - 1, false);
+                if (score > alpha && !m_aborted)
+                    score = -search(nextPlayer, nextOpponent, -beta, -alpha, empties - 1, false);
+            }
+            if (m_aborted) break;
+
+            if (score > alpha) {
+                alpha = score;
+                result.move = square;
+            }
+        }
+
+        result.score = alpha;
+        result.nodes = m_nodes;
+        result.solved = !m_aborted;
+        return result;
+    }
+
+private:
+    struct SortedMoves {
+        struct Entry { int square; Board::Bitboard flips; };
+        Entry moves[Board::MAX_MOVES];
+        int count = 0;
+    };
+
+    TranspositionTable m_tt;
+    size_t m_nodes = 0;
+    bool m_aborted = false;
+    int m_timeBudgetMs = 0;
+    std::chrono::steady_clock::time_point m_start;
+    const std::atomic<bool>* m_stop = nullptr;
+
+    bool outOfTime() {
+        /*
+            The clock and the stop flag are read every 4096 nodes
+        */
+        if ((m_nodes & 4095) == 0) {
+            if (m_stop && m_stop->load(std::memory_order_relaxed)) m_aborted = true;
+            else if (m_timeBudgetMs > 0) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - m_start).count();
+                if (elapsed >= m_timeBudgetMs) m_aborted = true;
+            }
+        }
+        return m_aborted;
+    }
+
+    static int finalScore(Board::Bitboard player, Board::Bitboard opponent) {
+        // empty squares go to the winner
+        int diff = std::popcount(player) - std::popcount(opponent);
+        int empties = 64 - std::popcount(player | opponent);
+        if (diff > 0) return diff + empties;
+        if (diff < 0) return diff - empties;
+        return 0;
+    }
+
+    static uint64_t hashKey(Board::Bitboard player, Board::Bitboard opponent) {
+        // the side to move is not needed, the player is always first
+        uint64_t key = player * 0x9e3779b97f4a7c15ULL;
+        key ^= std::rotl(opponent * 0xbf58476d1ce4e5b9ULL, 32);
+        return key ^ (key >> 29);
+    }
+
+    static Board::Bitboard oddQuadrants(Board::Bitboard empty) {
+        /*
+            Squares in quadrants with an odd number of empties.
+            Playing there first tends to leave the last move in each
+            region to us.
+        */
+        constexpr Board::Bitboard QUADRANTS[4] = {
+            0x000000000f0f0f0fULL, 0x00000000f0f0f0f0ULL,
+            0x0f0f0f0f00000000ULL, 0xf0f0f0f000000000ULL,
+        };
+        Board::Bitboard odd = 0;
+        for (Board::Bitboard quadrant : QUADRANTS)
+            if (std::popcount(empty & quadrant) & 1) odd |= quadrant;
+        return odd;
+    }
+
+    void orderMoves(SortedMoves& list, Board::Bitboard player, Board::Bitboard opponent, int hashMove) {
+        /*
+            Fastest-first: fewest replies for the opponent, corners
+            and odd quadrants break ties. The hash move goes first.
+        */
+        constexpr Board::Bitboard CORNERS = 0x8100000000000081ULL;
+        Board::Bitboard moves = Board::generateMoves(player, opponent);
+        Board::Bitboard odd = oddQuadrants(~(player | opponent));
+        int scores[Board::MAX_MOVES];
+        list.count = 0;
+
+        while (moves) {
+            int square = std::countr_zero(moves);
+            moves &= moves - 1;
+            Board::Bitboard bit = Board::squareBit(square);
+            Board::Bitboard flips = Board::computeFlips(square, player, opponent);
+
+            int score;
+            if (square == hashMove) score = -(1 << 20);
+            else {
+                score = std::popcount(Board::generateMoves(opponent & ~flips, player | flips | bit)) * 4;
+                if (bit & CORNERS) score -= 2;
+                if (bit & odd) score -= 1;
+            }
+
+            // insertion sort, lowest score first
+            int j = list.count++;
+            while (j > 0 && scores[j - 1] > score) {
+                list.moves[j] = list.moves[j - 1];
+                scores[j] = scores[j - 1];
+                j--;
+            }
+            list.moves[j] = {square, flips};
+            scores[j] = score;
+        }
+    }
+
+    int search(Board::Bitboard player, Board::Bitboard opponent, int alpha, int beta, int empties, bool passed) {
+        if (empties <= SHALLOW_EMPTIES) return searchShallow(player, opponent, alpha, beta, empties, passed);
+
+        m_nodes++;
+        if (outOfTime()) return 0;
+
+        Board::Bitboard moves = Board::generateMoves(player, opponent);
+        if (!moves) {
+            if (passed) return finalScore(player, opponent);
+            return -search(opponent, player, -beta, -alpha, empties, true);
+        }
+
+        // same position always has the same empties, any entry is deep enough
+        uint64_t key = hashKey(player, opponent);
+        int hashMove = -1;
+        TTEntry entry;
+        if (m_tt.probe(key, entry)) {
+            hashMove = entry.bestMove;
+            if (entry.bound == Bound::EXACT) return entry.score;
+            if (entry.bound == Bound::LOWER) alpha = std::max(alpha, static_cast<int>(entry.score));
+            if (entry.bound == Bound::UPPER) beta = std::min(beta, static_cast<int>(entry.score));
+            if (alpha >= beta) return entry.score;
+        }
+
+        SortedMoves list;
+        orderMoves(list, player, opponent, hashMove);
+
+        int originalAlpha = alpha;
+        int best = -SCORE_MAX - 1;
+        int bestMove = -1;
+        for (int i = 0; i < list.count; i++) {
+            auto [square, flips] = list.moves[i];
+            Board::Bitboard nextPlayer = opponent & ~flips;
+            Board::Bitboard nextOpponent = player | flips | Board::squareBit(square);
+
+            int score;
+            if (i == 0) score = -search(nextPlayer, nextOpponent, -beta, -alpha, empties - 1, false);
+            else {
+                score = -search(nextPlayer, nextOpponent, -alpha - 1, -alpha, empties - 1, false);
+                if (score > alpha && score < beta)
+                    score = -search(nextPlayer, nextOpponent, -beta, -score, empties - 1, false);
+            }
+            if (m_aborted) return 0;
+
+            if (score > best) {
+                best = score;
+                bestMove = square;
+                if (score > alpha) alpha = score;
+                if (alpha >= beta) break;
+            }
+        }
+
+        Bound bound = (best <= originalAlpha) ? Bound::UPPER : (best >= beta) ? Bound::LOWER : Bound::EXACT;
+        m_tt.store(key, empties, bound, best, bestMove);
+        return best;
+    }
+
+    int searchShallow(Board::Bitboard player, Board::Bitboard opponent, int alpha, int beta, int empties, bool passed) {
+        /*
+            Last few empties. Moves are found by trying each empty
+            square directly, odd quadrants first, with no table.
+        */
+        m_nodes++;
+        if (empties == 1) return solveLast(player, opponent);
+
+        Board::Bitboard empty = ~(player | opponent);
+        Board::Bitboard odd = oddQuadrants(empty);
+        int best = -SCORE_MAX - 1;
+
+        for (Board::Bitboard squares : {empty & odd, empty & ~odd}) {
+            while (squares) {
+                int square = std::countr_zero(squares);
+                squares &= squares - 1;
+                Board::Bitboard flips = Board::computeFlips(square, player, opponent);
+                if (!flips) continue;
+
+                int score = -searchShallow(opponent & ~flips, player | flips | Board::squareBit(square), -beta, -alpha, empties - 1, false);
+                if (score > best) {
+                    best = score;
+                    if (score > alpha) alpha = score;
+                    if (alpha >= beta) return best;
+                }
+            }
+        }
+
+        // no move: pass, or the game is over
+        if (best == -SCORE_MAX - 1) {
+            if (passed) return finalScore(player, opponent);
+            return -searchShallow(opponent, player, -beta, -alpha, empties, true);
+        }
+        return best;
+    }
+
+    int solveLast(Board::Bitboard player, Board::Bitboard opponent) {
+        /*
+            One empty square left: whoever can move there does,
+            player first, no search needed
+        */
+        int square = std::countr_zero(~(player | opponent));
+
+        int flipped = std::popcount(Board::computeFlips(square, player, opponent));
+        if (flipped) return 2 * (std::popcount(player) + 1 + flipped) - 64;
+
+        flipped = std::popcount(Board::computeFlips(square, opponent, player));
+        if (flipped) return 64 - 2 * (std::popcount(opponent) + 1 + flipped);
+
+        return finalScore(player, opponent);
+    }
+};
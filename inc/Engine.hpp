@@ -0,0 +1,21 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Headless engine. Everything needed to search Othello
+          positions, with no SFML or UILO dependency. Tools and
+          servers include this instead of Othello.hpp.
+*/
+
+#pragma once
+
+#include "Bitboard.hpp"
+#include "Board.hpp"
+#include "SearchTree.hpp"
+#include "Evaluator.hpp"
+#include "PatternEvaluator.hpp"
+#include "EndgameSolver.hpp"
+#include "OpeningBook.hpp"
+#include "ProbCut.hpp"
+#include "OthelloBot.hpp"
+#include "EngineWorker.hpp"
+#include "BatchAnalyzer.hpp"
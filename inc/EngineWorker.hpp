@@ -0,0 +1,97 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Long-lived search workers. A bot is handed to the pool with
+          a position and its move comes back through a future. The
+          worker threads are started once and serve every bot, so
+          any number of games can share one pool, as many searching
+          at once as there are workers.
+
+          Ownership: a bot belongs to the pool from submit() until
+          its future is ready. The caller must not touch it (settings,
+          stats, tree) in between, and a bot has at most one request
+          in flight. Everything a search learns stays in the bot, not
+          in the worker thread: table, history and killer moves carry
+          over to the bot's next move whichever worker runs it.
+*/
+
+#pragma once
+
+#include "Board.hpp"
+#include "OthelloBot.hpp"
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+class EngineWorker {
+public:
+    using Result = std::pair<int, int>;
+
+    explicit EngineWorker(int workers = 1) {
+        for (int i = 0; i < std::max(1, workers); i++)
+            m_workers.emplace_back([this](std::stop_token shutdown) { run(shutdown); });
+    }
+
+    // searches still running or queued are stopped, they all get a move
+    ~EngineWorker() {
+        for (auto& worker : m_workers) worker.request_stop();
+        m_workers.clear();
+    }
+
+    EngineWorker(const EngineWorker&) = delete;
+    EngineWorker& operator=(const EngineWorker&) = delete;
+
+    /*
+        Queue a search of state by bot. Requests start in the order
+        they came in. A stop request ends the search early (or at
+        once, if it is still queued) with the best move found so far.
+    */
+    std::future<Result> submit(OthelloBot& bot, const Board::State& state, std::stop_token stop = {}) {
+        Request request{&bot, state, std::move(stop), {}};
+        std::future<Result> result = request.result.get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(std::move(request));
+        }
+        m_ready.notify_one();
+        return result;
+    }
+
+    int workers() const { return static_cast<int>(m_workers.size()); }
+
+private:
+    struct Request {
+        OthelloBot* bot = nullptr;
+        Board::State state;
+        std::stop_token stop;
+        std::promise<Result> result;
+    };
+
+    void run(std::stop_token shutdown) {
+        while (true) {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_ready.wait(lock, shutdown, [this] { return !m_queue.empty(); });
+                if (m_queue.empty()) return;
+                request = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+
+            // stopped by the caller or by the pool shutting down
+            std::stop_source stop;
+            std::stop_callback onStop(request.stop, [&stop] { stop.request_stop(); });
+            std::stop_callback onShutdown(shutdown, [&stop] { stop.request_stop(); });
+            request.result.set_value(request.bot->getBestMove(request.state, stop.get_token()));
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable_any m_ready;
+    std::deque<Request> m_queue;
+    std::vector<std::jthread> m_workers;
+};
@@ -0,0 +1,66 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Evaluation interface used at the leaves of the search.
+          Scores are in discs, white - black, the same scale as the
+          final disc count. DiscEvaluator is the plain disc count.
+          Positions can also be scored in batches, stored column by
+          column so an evaluator can load several at once.
+*/
+
+#pragma once
+
+#include "Bitboard.hpp"
+
+/*
+    Up to CAPACITY positions, one array per field. Holds every
+    child of a node, so the positions carry no hash.
+*/
+struct PositionBatch {
+    static constexpr int CAPACITY = Board::MAX_MOVES;
+
+    Board::Bitboard black[CAPACITY];
+    Board::Bitboard white[CAPACITY];
+    char turn[CAPACITY];
+    int count = 0;
+
+    void clear() { count = 0; }
+    void push(const Board::Position& pos) {
+        black[count] = pos.black;
+        white[count] = pos.white;
+        turn[count] = pos.turn;
+        count++;
+    }
+};
+
+class Evaluator {
+public:
+    virtual ~Evaluator() = default;
+
+    // estimated final disc differential, white - black
+    virtual int evaluate(const Board::Position& pos) const = 0;
+    virtual const char* name() const = 0;
+
+    // evaluate for every position of the batch, into scores
+    virtual void evaluateBatch(const PositionBatch& batch, int* scores) const {
+        Board::Position pos;
+        for (int i = 0; i < batch.count; i++) {
+            pos.black = batch.black[i];
+            pos.white = batch.white[i];
+            pos.turn = batch.turn[i];
+            scores[i] = evaluate(pos);
+        }
+    }
+};
+
+class DiscEvaluator : public Evaluator {
+public:
+    int evaluate(const Board::Position& pos) const override {
+        return pos.whiteCount() - pos.blackCount();
+    }
+    void evaluateBatch(const PositionBatch& batch, int* scores) const override {
+        for (int i = 0; i < batch.count; i++)
+            scores[i] = std::popcount(batch.white[i]) - std::popcount(batch.black[i]);
+    }
+    const char* name() const override { return "disc"; }
+};
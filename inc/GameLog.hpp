@@ -0,0 +1,139 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Game logs read by the offline tools. A file holds either
+          format, mixed freely:
+            transcripts, one game per line: squares in order, as
+              "f5d6c3d3..." (spaces allowed, "pass" optional, '#'
+              starts a comment, as in tools/match logs)
+            GUI move history (like AI_winning_seq.txt): lines
+              "B: row:col", a game ends at "Winner:" or at the next
+              "=== Move History ==="
+          Passes are left out, replaying a game infers them.
+*/
+
+#pragma once
+
+#include "Bitboard.hpp"
+#include "Board.hpp"
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct Game {
+    std::vector<int> moves;     // squares, passes left out
+    bool ended = false;         // the log says the game is over
+};
+
+/*
+    Reads games from a list of files one at a time. rewind() starts
+    over from the first file for the next epoch.
+*/
+class GameStream {
+public:
+    explicit GameStream(std::vector<std::string> paths) : m_paths(std::move(paths)) {}
+
+    void rewind() {
+        m_file = 0;
+        m_pendingHistory = false;
+        m_in.close();
+        m_in.clear();
+    }
+
+    bool next(Game& game) {
+        game.moves.clear();
+        game.ended = false;
+        bool inHistory = m_pendingHistory;
+        m_pendingHistory = false;
+        std::string line;
+
+        while (true) {
+            if (!m_in.is_open()) {
+                if (m_file >= m_paths.size()) return false;
+                m_in.open(m_paths[m_file++]);
+                if (!m_in) {
+                    std::cerr << "can't read " << m_paths[m_file - 1] << "\n";
+                    continue;
+                }
+            }
+
+            if (!std::getline(m_in, line)) {
+                m_in.close();
+                m_in.clear();
+                // a history at the end of a file without a "Winner:" line
+                if (inHistory && !game.moves.empty()) return true;
+                inHistory = false;
+                game.moves.clear();
+                continue;
+            }
+
+            if (line.find("Move History") != std::string::npos) {
+                // no "Winner:" line, this header starts the next game
+                if (inHistory && !game.moves.empty()) {
+                    m_pendingHistory = true;
+                    return true;
+                }
+                inHistory = true;
+                continue;
+            }
+
+            if (inHistory) {
+                if (line.find("Winner:") != std::string::npos) {
+                    inHistory = false;
+                    game.ended = true;
+                    if (!game.moves.empty()) return true;
+                    continue;
+                }
+                int square = parseHistoryMove(line);
+                if (square >= 0) game.moves.push_back(square);
+                continue;
+            }
+
+            if (parseTranscript(line, game)) return true;
+        }
+    }
+
+private:
+    std::vector<std::string> m_paths;
+    size_t m_file = 0;
+    std::ifstream m_in;
+    bool m_pendingHistory = false;
+
+    static int parseHistoryMove(const std::string& line) {
+        // "B: 4:5", side letter then row:col
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) return -1;
+        int row = -1, col = -1;
+        if (std::sscanf(line.c_str() + colon + 1, " %d:%d", &row, &col) != 2) return -1;
+        if (row < 0 || row >= 8 || col < 0 || col >= 8) return -1;
+        return Board::squareIndex(row, col);
+    }
+
+    static bool parseTranscript(const std::string& line, Game& game) {
+        // anything after '#' is a comment, as in match logs
+        std::string text;
+        for (char c : line.substr(0, line.find('#')))
+            if (!std::isspace(static_cast<unsigned char>(c))) text += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (text.empty()) return false;
+
+        game.moves.clear();
+        for (size_t i = 0; i < text.size();) {
+            if (text.compare(i, 4, "pass") == 0) {
+                i += 4;
+                continue;
+            }
+            int square = Board::parseSquare(text.substr(i, 2));
+            if (square < 0) {
+                game.moves.clear();
+                return false;
+            }
+            game.moves.push_back(square);
+            i += 2;
+        }
+        return !game.moves.empty();
+    }
+};
+
@@ -0,0 +1,154 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Move ordering for alpha-beta. Moves are tried in the order:
+          PV move, hash move, killer moves, then by history score and
+          static square weight. Near the root, where nodes are few and
+          subtrees are big, the opponent's mobility after the move
+          is also taken into account. Keeps per-depth cutoff counts.
+*/
+
+#pragma once
+
+#include "Bitboard.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+// static value of each square: corners first, X/C squares (next to
+// an empty corner) last
+constexpr int SQUARE_WEIGHTS[64] = {
+    100, -20,  10,   5,   5,  10, -20, 100,
+    -20, -50,  -2,  -2,  -2,  -2, -50, -20,
+     10,  -2,   1,   1,   1,   1,  -2,  10,
+      5,  -2,   1,   0,   0,   1,  -2,   5,
+      5,  -2,   1,   0,   0,   1,  -2,   5,
+     10,  -2,   1,   1,   1,   1,  -2,  10,
+    -20, -50,  -2,  -2,  -2,  -2, -50, -20,
+    100, -20,  10,   5,   5,  10, -20, 100,
+};
+
+struct CutoffStats {
+    static constexpr int MAX_DEPTH = 64;
+
+    // indexed by remaining depth
+    size_t nodes[MAX_DEPTH] = {};               // interior nodes searched
+    size_t cutoffs[MAX_DEPTH] = {};             // nodes that failed high/low
+    size_t firstMoveCutoffs[MAX_DEPTH] = {};    // of those, cut on the first move
+
+    void clear() { *this = CutoffStats{}; }
+
+    double cutoffRate(int depth) const {
+        return nodes[depth] ? static_cast<double>(cutoffs[depth]) / nodes[depth] : 0.0;
+    }
+
+    double firstMoveRate(int depth) const {
+        return cutoffs[depth] ? static_cast<double>(firstMoveCutoffs[depth]) / cutoffs[depth] : 0.0;
+    }
+};
+
+class MoveOrderer {
+public:
+    static constexpr int MAX_PLY = 64;
+
+    // remaining depth from which opponent mobility is worth computing
+    static constexpr int MOBILITY_DEPTH = 4;
+
+    MoveOrderer() { clear(); }
+
+    void clear() {
+        std::memset(m_killers, -1, sizeof(m_killers));
+        std::memset(m_history, 0, sizeof(m_history));
+        m_stats.clear();
+    }
+
+    void newSearch() {
+        /*
+            Keep what was learned last move but let it fade, and
+            start the cutoff counts over
+        */
+        for (auto& color : m_history)
+            for (int& score : color)
+                score /= 2;
+        m_stats.clear();
+    }
+
+    const CutoffStats& stats() const { return m_stats; }
+
+    void order(Board::MoveList& moves, const Board::Position& pos, int ply, int depth, int pvMove, int hashMove) {
+        /*
+            Score every move and sort best first. Insertion sort,
+            the lists are short.
+        */
+        int scores[Board::MAX_MOVES];
+        int color = (pos.turn == 'b') ? 0 : 1;
+        bool useMobility = depth >= MOBILITY_DEPTH;
+
+        for (int i = 0; i < moves.size(); i++) {
+            const Board::Move& move = moves[i];
+            int square = move.square;
+
+            if (square == pvMove) scores[i] = 1 << 30;
+            else if (square == hashMove) scores[i] = 1 << 29;
+            else if (ply < MAX_PLY && square == m_killers[ply][0]) scores[i] = 1 << 28;
+            else if (ply < MAX_PLY && square == m_killers[ply][1]) scores[i] = 1 << 27;
+            else {
+                scores[i] = m_history[color][square] + SQUARE_WEIGHTS[square] * 16;
+
+                // fewer replies for the opponent is better
+                if (useMobility) {
+                    Board::Bitboard player = pos.player() | Board::squareBit(square) | move.flips;
+                    Board::Bitboard opponent = pos.opponent() & ~move.flips;
+                    scores[i] -= std::popcount(Board::generateMoves(opponent, player)) * 256;
+                }
+            }
+        }
+
+        for (int i = 1; i < moves.size(); i++) {
+            Board::Move move = moves[i];
+            int score = scores[i];
+            int j = i - 1;
+            while (j >= 0 && scores[j] < score) {
+                moves[j + 1] = moves[j];
+                scores[j + 1] = scores[j];
+                j--;
+            }
+            moves[j + 1] = move;
+            scores[j + 1] = score;
+        }
+    }
+
+    void recordNode(int depth) {
+        if (depth < CutoffStats::MAX_DEPTH) m_stats.nodes[depth]++;
+    }
+
+    void recordCutoff(const Board::Position& pos, int square, int ply, int depth, int moveIndex) {
+        /*
+            square refuted the previous move. Remember it as a killer
+            for this ply and raise its history score for this color.
+        */
+        if (depth < CutoffStats::MAX_DEPTH) {
+            m_stats.cutoffs[depth]++;
+            if (moveIndex == 0) m_stats.firstMoveCutoffs[depth]++;
+        }
+
+        if (ply < MAX_PLY && m_killers[ply][0] != square) {
+            m_killers[ply][1] = m_killers[ply][0];
+            m_killers[ply][0] = square;
+        }
+
+        int color = (pos.turn == 'b') ? 0 : 1;
+        m_history[color][square] += depth * depth;
+
+        // keep history below the killer and hash move scores
+        if (m_history[color][square] > (1 << 20))
+            for (auto& c : m_history)
+                for (int& score : c)
+                    score /= 2;
+    }
+
+private:
+    int m_killers[MAX_PLY][2];
+    int m_history[2][64];
+    CutoffStats m_stats;
+};
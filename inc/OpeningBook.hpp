@@ -0,0 +1,169 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Opening book. Positions are stored once for all 8 board
+          symmetries: a position is keyed by the smallest of its
+          symmetric copies (player, opponent), and the book move is
+          stored in that copy's frame. The entries are sorted by key
+          in a memory-mapped file and found by binary search.
+
+          tools/book.cpp builds the file from game logs. book.bin in
+          the working directory is picked up by defaultInstance().
+*/
+
+#pragma once
+
+#include "Bitboard.hpp"
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct BookKey {
+    Board::Bitboard player = 0;
+    Board::Bitboard opponent = 0;
+
+    bool operator<(const BookKey& other) const {
+        return player != other.player ? player < other.player : opponent < other.opponent;
+    }
+    bool operator==(const BookKey& other) const = default;
+};
+
+struct BookEntry {
+    BookKey key;
+    int16_t score = 0;      // discs for the side to move
+    uint8_t move = 0;       // square, in the key's frame
+    uint8_t reserved = 0;
+    uint32_t games = 0;     // games in the log that reached the position
+};
+static_assert(sizeof(BookEntry) == 24, "book entries are written to disk as-is");
+
+/*
+    Book file layout: this header, then count BookEntry records sorted
+    by key, in host (little-endian) byte order
+*/
+struct BookFileHeader {
+    char magic[4] = {'O', 'T', 'B', 'K'};
+    uint32_t version = 1;
+    uint64_t count = 0;
+};
+
+/*
+    Smallest symmetric copy of (player, opponent) and the symmetry
+    that produces it
+*/
+inline BookKey normalizeBookKey(Board::Bitboard player, Board::Bitboard opponent, int& symmetry) {
+    BookKey best{player, opponent};
+    symmetry = 0;
+    for (int s = 1; s < Board::SYMMETRIES; s++) {
+        BookKey key{Board::symmetry(player, s), Board::symmetry(opponent, s)};
+        if (key < best) {
+            best = key;
+            symmetry = s;
+        }
+    }
+    return best;
+}
+
+class OpeningBook {
+public:
+    static constexpr const char* DEFAULT_BOOK_FILE = "book.bin";
+
+    struct Hit {
+        int move = -1;      // square on the real board
+        int score = 0;      // discs for the side to move
+        int games = 0;
+    };
+
+    /*
+        Map a book file. On failure the book is left empty and
+        false is returned.
+    */
+    bool load(const std::string& path) {
+        m_entries = nullptr;
+        m_count = 0;
+        if (!m_file.open(path)) return false;
+
+        BookFileHeader header, expected;
+        if (m_file.size() < sizeof(header)) {
+            m_file.close();
+            return false;
+        }
+        std::memcpy(&header, m_file.data(), sizeof(header));
+        if (std::memcmp(header.magic, expected.magic, 4) || header.version != expected.version
+            || m_file.size() != sizeof(header) + header.count * sizeof(BookEntry)) {
+            m_file.close();
+            return false;
+        }
+
+        // the 16 byte header keeps the entries 8-byte aligned in the mapping
+        m_entries = reinterpret_cast<const BookEntry*>(m_file.data() + sizeof(header));
+        m_count = static_cast<size_t>(header.count);
+        return true;
+    }
+
+    static bool save(const std::string& path, std::vector<BookEntry> entries) {
+        std::sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) { return a.key < b.key; });
+        BookFileHeader header;
+        header.count = entries.size();
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(BookEntry));
+        return static_cast<bool>(out);
+    }
+
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+
+    /*
+        Book move for pos. Fails if the position is not in the book
+        or its move is not legal here.
+    */
+    bool probe(const Board::Position& pos, Hit& hit) const {
+        if (!m_count) return false;
+
+        int symmetry;
+        BookKey key = normalizeBookKey(pos.player(), pos.opponent(), symmetry);
+        const BookEntry* end = m_entries + m_count;
+        const BookEntry* entry = std::lower_bound(m_entries, end, key,
+            [](const BookEntry& e, const BookKey& k) { return e.key < k; });
+        if (entry == end || !(entry->key == key)) return false;
+
+        // the legal move that lands on the stored square in the key's frame
+        Board::Bitboard target = Board::squareBit(entry->move);
+        Board::Bitboard moves = pos.legalMoves();
+        while (moves) {
+            int square = std::countr_zero(moves);
+            moves &= moves - 1;
+            if (Board::symmetry(Board::squareBit(square), symmetry) == target) {
+                hit.move = square;
+                hit.score = entry->score;
+                hit.games = static_cast<int>(entry->games);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*
+        Shared book, loaded once from book.bin in the working
+        directory. Empty when there is no valid file.
+    */
+    static std::shared_ptr<const OpeningBook> defaultInstance() {
+        static std::shared_ptr<const OpeningBook> instance = [] {
+            auto book = std::make_shared<OpeningBook>();
+            book->load(DEFAULT_BOOK_FILE);
+            return book;
+        }();
+        return instance;
+    }
+
+private:
+    MappedFile m_file;
+    const BookEntry* m_entries = nullptr;
+    size_t m_count = 0;
+};
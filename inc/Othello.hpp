@@ -11,6 +11,7 @@
 
 #include "Board.hpp"
 #include "OthelloBot.hpp"
+#include "EngineWorker.hpp"
 #include "Util.hpp"
 #include "TreeDisplay.hpp"
 
@@ -18,6 +19,7 @@
 #include <atomic>
 #include <chrono>
 #include <future>
+#include <stop_token>
 
 using namespace uilo;
 
@@ -34,6 +36,8 @@ public:
     void updateGame();
     void renderGrid();
     void startBotThinking();
+    void stopBotThinking();
+    void stopPondering();
     
     std::pair<int, int> mouseToGridPos(sf::Vector2i mousePos);
 
@@ -56,6 +60,8 @@ private:
     ScrollableColumn* m_whiteColumn = nullptr;
     Slider* m_blackDepthSlider = nullptr;
     Slider* m_whiteDepthSlider = nullptr;
+    Slider* m_blackTimeSlider = nullptr;
+    Slider* m_whiteTimeSlider = nullptr;
     Button* m_blackAlphaBetaToggle = nullptr;
     Button* m_whiteAlphaBetaToggle = nullptr;
     Button* m_enableBlackTree = nullptr;
@@ -78,8 +84,11 @@ private:
     
     bool m_mouseWasPressed = false;
     
+    // searches run on the worker, a bot is off limits while its move is pending
+    EngineWorker m_engine;
     std::atomic<bool> m_botThinking = false;
     std::future<std::pair<int, int>> m_botMoveResult;
+    std::stop_source m_botStop;
     std::chrono::steady_clock::time_point m_botStartTime;
     std::chrono::milliseconds m_botMoveDelay{500};
     bool m_waitingForTimer = false;
@@ -87,6 +96,8 @@ private:
 
     int m_blackDepth = 4;
     int m_whiteDepth = 4;
+    int m_blackTimeMs = 0;
+    int m_whiteTimeMs = 0;
 
     bool m_fullscreen = false;
 
@@ -105,9 +116,14 @@ struct Theme {
     sf::Color textColor             = fromHex("#d8d8d8ff");
 } uiTheme;
 
-Othello::Othello() { m_running = initUI(); }
+Othello::Othello() {
+    // bots start on one thread, updateGame adds cores with a time budget
+    m_running = initUI();
+}
 
-Othello::~Othello() {}
+Othello::~Othello() {
+    stopBotThinking();
+}
 
 bool Othello::initUI() {
     /*
@@ -146,6 +162,9 @@ bool Othello::initUI() {
             .onLClick([&](){ 
                 m_blackColumn->m_modifier.setVisible(!m_blackColumn->m_modifier.isVisible()); 
                 m_blackEnabled = !m_blackEnabled;
+                if (m_board.turn == 'b') stopBotThinking();
+                // black's change turns white's opponent into a bot or a human
+                stopPondering();
                 m_enableBlackButton->m_modifier.setColor(m_blackEnabled ? uiTheme.buttonColor : sf::Color::Black);
                 // std::cout << "Black AI Enabled.\n";
             }),
@@ -165,6 +184,8 @@ bool Othello::initUI() {
             .onLClick([&](){ 
                 m_whiteColumn->m_modifier.setVisible(!m_whiteColumn->m_modifier.isVisible()); 
                 m_whiteEnabled = !m_whiteEnabled;
+                if (m_board.turn == 'w') stopBotThinking();
+                stopPondering();
                 m_enableWhiteButton->m_modifier.setColor(m_whiteEnabled ? uiTheme.buttonColor : sf::Color::Black);
                 // std::cout << "White AI Enabled.\n";
             }),
@@ -182,6 +203,8 @@ bool Othello::initUI() {
             .align(Align::CENTER_X | Align::CENTER_Y)
             .setColor(uiTheme.buttonColor)
             .onLClick([&](){ 
+                stopBotThinking();
+                stopPondering();
                 m_board.clear(); 
                 m_moveHistory.clear();
             }),
@@ -222,10 +245,10 @@ bool Othello::initUI() {
                         auto move = (m_board.turn == 'b') ? m_blackBot.getBestMove(tempBoard) : m_whiteBot.getBestMove(tempBoard);
                         
                         auto& tree = (m_board.turn == 'b') ? m_blackBot.getSearchTree() : m_whiteBot.getSearchTree();
-                        if (tree.getRoot()) {
-                            for (auto& child : tree.getRoot()->children) {
-                                if (child->row == move.first && child->col == move.second) {
-                                    m_lastMoveSequence = child->moveSequence;
+                        if (tree.hasRoot()) {
+                            for (SearchTree::Index child : tree.children(SearchTree::ROOT)) {
+                                if (tree.node(child).row() == move.first && tree.node(child).col() == move.second) {
+                                    m_lastMoveSequence = tree.moveSequence(child);
                                     break;
                                 }
                             }
@@ -310,6 +333,24 @@ bool Othello::initUI() {
     );
     m_whiteDepthSlider->setQuantization(9);
 
+    m_blackTimeSlider = slider(
+        Modifier(),
+        sf::Color::White,
+        sf::Color::Black,
+        SliderOrientation::Horizontal,
+        0.f
+    );
+    m_blackTimeSlider->setQuantization(10);
+
+    m_whiteTimeSlider = slider(
+        Modifier(),
+        sf::Color::White,
+        sf::Color::Black,
+        SliderOrientation::Horizontal,
+        0.f
+    );
+    m_whiteTimeSlider->setQuantization(10);
+
     m_blackAlphaBetaToggle = button(
         Modifier()
             .setfixedHeight(24.f)
@@ -317,6 +358,7 @@ bool Othello::initUI() {
             .align(Align::RIGHT | Align::CENTER_Y)
             .setColor(m_blackBot.alphaBetaEnabled() ? uiTheme.buttonColor : sf::Color::Black)
             .onLClick([&](){ 
+                if (m_board.turn == 'b') stopBotThinking();
                 m_blackBot.toggleAlphaBeta(); 
                 m_blackAlphaBetaToggle->m_modifier.setColor(m_blackBot.alphaBetaEnabled() ? uiTheme.buttonColor : sf::Color::Black); 
             }),
@@ -334,6 +376,7 @@ bool Othello::initUI() {
             .align(Align::RIGHT | Align::CENTER_Y)
             .setColor(m_whiteBot.alphaBetaEnabled() ? uiTheme.buttonColor : sf::Color::Black)
             .onLClick([&](){ 
+                if (m_board.turn == 'w') stopBotThinking();
                 m_whiteBot.toggleAlphaBeta(); 
                 m_whiteAlphaBetaToggle->m_modifier.setColor(m_whiteBot.alphaBetaEnabled() ? uiTheme.buttonColor : sf::Color::Black); 
             }),
@@ -352,6 +395,8 @@ bool Othello::initUI() {
             .setColor(uiTheme.buttonColor)
             .onLClick([&](){ 
                 if (!m_blackTree) {
+                    if (m_board.turn == 'b') stopBotThinking();
+                    m_blackBot.setTreeRecording(true);
                     m_blackTree = new TreeDisplay(const_cast<SearchTree&>(m_blackBot.getSearchTree()));
                 }
             }),
@@ -370,6 +415,8 @@ bool Othello::initUI() {
             .setColor(uiTheme.buttonColor)
             .onLClick([&](){ 
                 if (!m_whiteTree) {
+                    if (m_board.turn == 'w') stopBotThinking();
+                    m_whiteBot.setTreeRecording(true);
                     m_whiteTree = new TreeDisplay(const_cast<SearchTree&>(m_whiteBot.getSearchTree()));
                 }
             }),
@@ -404,6 +451,25 @@ bool Othello::initUI() {
 
         spacer(Modifier().setfixedHeight(16)),
 
+        row(
+            Modifier().setfixedHeight(32).setWidth(0.8f).align(Align::CENTER_X),
+        contains{
+            text(
+                Modifier().setfixedHeight(24).setColor(uiTheme.textColor).align(Align::CENTER_Y),
+                "Time",
+                "",
+                "black_time_text"
+            )
+        }),
+
+        row(
+            Modifier().setfixedHeight(32).setWidth(0.8f).align(Align::CENTER_X),
+        contains{
+            m_blackTimeSlider
+        }),
+
+        spacer(Modifier().setfixedHeight(16)),
+
         row(
             Modifier().setfixedHeight(32).setWidth(0.8f).align(Align::CENTER_X),
         contains{
@@ -435,6 +501,17 @@ bool Othello::initUI() {
                 "black_states_text"
             )
         }),
+
+        row(
+            Modifier().setfixedHeight(24).setWidth(0.8f).align(Align::CENTER_X),
+        contains{
+            text(
+                Modifier().setfixedHeight(24).setColor(uiTheme.textColor).align(Align::CENTER_Y),
+                "",
+                "",
+                "black_hash_text"
+            )
+        }),
     }); m_blackColumn->m_modifier.setVisible(false);
 
     m_whiteColumn = scrollableColumn(
@@ -461,6 +538,25 @@ bool Othello::initUI() {
 
         spacer(Modifier().setfixedHeight(16)),
 
+        row(
+            Modifier().setfixedHeight(32).setWidth(0.8f).align(Align::CENTER_X),
+        contains{
+            text(
+                Modifier().setfixedHeight(24).setColor(uiTheme.textColor).align(Align::CENTER_Y),
+                "Time",
+                "",
+                "white_time_text"
+            )
+        }),
+
+        row(
+            Modifier().setfixedHeight(32).setWidth(0.8f).align(Align::CENTER_X),
+        contains{
+            m_whiteTimeSlider
+        }),
+
+        spacer(Modifier().setfixedHeight(16)),
+
         row(
             Modifier().setfixedHeight(32).setWidth(0.8f).align(Align::CENTER_X),
         contains{
@@ -492,6 +588,17 @@ bool Othello::initUI() {
                 "white_states_text"
             )
         }),
+
+        row(
+            Modifier().setfixedHeight(24).setWidth(0.8f).align(Align::CENTER_X),
+        contains{
+            text(
+                Modifier().setfixedHeight(24).setColor(uiTheme.textColor).align(Align::CENTER_Y),
+                "",
+                "",
+                "white_hash_text"
+            )
+        }),
     }); m_whiteColumn->m_modifier.setVisible(false);
 
     m_mainContentRow = row(
@@ -532,6 +639,8 @@ void Othello::update() {
         if (!m_blackTree->isRunning()) {
             delete m_blackTree;
             m_blackTree = nullptr;
+            if (m_board.turn == 'b') stopBotThinking();
+            m_blackBot.setTreeRecording(false);
         }
     }
     if (m_whiteTree) {
@@ -539,6 +648,8 @@ void Othello::update() {
         if (!m_whiteTree->isRunning()) {
             delete m_whiteTree;
             m_whiteTree = nullptr;
+            if (m_board.turn == 'w') stopBotThinking();
+            m_whiteBot.setTreeRecording(false);
         }
     }
 
@@ -561,19 +672,75 @@ void Othello::updateGame() {
     /*
         Update board state, check for player move, execute bot moves
     */
+    // a setting changed under the running search drops it, the bot starts over
+    auto settingChanged = [&](char turn) {
+        if (m_board.turn == turn) stopBotThinking();
+    };
+
+    int blackDepth = m_blackDepth;
     m_blackDepth = static_cast<int>((m_blackDepthSlider->getValue() * 10) + 1);
     if (m_blackDepth == 11) m_blackDepth -= 1;
+    if (m_blackDepth != blackDepth) settingChanged('b');
     m_blackBot.setDepth(m_blackDepth);
 
+    int whiteDepth = m_whiteDepth;
     m_whiteDepth = static_cast<int>((m_whiteDepthSlider->getValue() * 10) + 1);
     if (m_whiteDepth == 11) m_whiteDepth -= 1;
+    if (m_whiteDepth != whiteDepth) settingChanged('w');
     m_whiteBot.setDepth(m_whiteDepth);
 
     m_ui->getText("black_depth_text")->setString("Depth: " + std::to_string(m_blackDepth));
     m_ui->getText("white_depth_text")->setString("Depth: " + std::to_string(m_whiteDepth));
+
+    // a time budget replaces the fixed depth with iterative deepening
+    int blackTimeMs = m_blackTimeMs;
+    m_blackTimeMs = static_cast<int>(m_blackTimeSlider->getValue() * 5000);
+    if (m_blackTimeMs != blackTimeMs) settingChanged('b');
+    m_blackBot.setTimeBudget(m_blackTimeMs);
+
+    int whiteTimeMs = m_whiteTimeMs;
+    m_whiteTimeMs = static_cast<int>(m_whiteTimeSlider->getValue() * 5000);
+    if (m_whiteTimeMs != whiteTimeMs) settingChanged('w');
+    m_whiteBot.setTimeBudget(m_whiteTimeMs);
+
+    // Lazy SMP helpers search past the fixed depth and add their nodes,
+    // so a fixed depth bot stays on one thread: depth N means N, and its
+    // state count compares with minimax. Only one bot thinks at a time,
+    // and bots ponder only against a human, so a timed bot gets every core.
+    auto threadsFor = [](int ms) {
+        return ms > 0 ? static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) : 1;
+    };
+    if (m_blackBot.getThreads() != threadsFor(m_blackTimeMs)) m_blackBot.setThreads(threadsFor(m_blackTimeMs));
+    if (m_whiteBot.getThreads() != threadsFor(m_whiteTimeMs)) m_whiteBot.setThreads(threadsFor(m_whiteTimeMs));
+
+    auto timeText = [](int ms, const OthelloBot& bot) {
+        if (ms <= 0) return std::string("Time: off");
+        return "Time: " + std::to_string(ms) + " ms (depth " + std::to_string(bot.getCompletedDepth()) + ")";
+    };
+    m_ui->getText("black_time_text")->setString(timeText(m_blackTimeMs, m_blackBot));
+    m_ui->getText("white_time_text")->setString(timeText(m_whiteTimeMs, m_whiteBot));
     
-    m_ui->getText("black_states_text")->setString("States: " + std::to_string(m_blackBot.getTreeSize()));
-    m_ui->getText("white_states_text")->setString("States: " + std::to_string(m_whiteBot.getTreeSize()));
+    // a solved endgame is exact, not an estimate
+    auto statesText = [](const OthelloBot& bot) {
+        return "States: " + std::to_string(bot.getTreeSize()) + (bot.isSolved() ? " (solved)" : bot.isBookMove() ? " (book)" : "");
+    };
+    auto hashStats = [](const OthelloBot& bot) {
+        return "Hash: " + std::to_string(static_cast<int>(bot.getHashHitRate() * 100)) + "% hit, "
+             + std::to_string(static_cast<int>(bot.getHashFill() * 100)) + "% full";
+    };
+    
+    // a searching bot's stats are written by its thread, they wait until it's done
+    auto searching = [&](const OthelloBot& bot, char turn) {
+        return bot.isPondering() || (m_botThinking && m_board.turn == turn);
+    };
+    if (!searching(m_blackBot, 'b')) {
+        m_ui->getText("black_states_text")->setString(statesText(m_blackBot));
+        m_ui->getText("black_hash_text")->setString(hashStats(m_blackBot));
+    }
+    if (!searching(m_whiteBot, 'w')) {
+        m_ui->getText("white_states_text")->setString(statesText(m_whiteBot));
+        m_ui->getText("white_hash_text")->setString(hashStats(m_whiteBot));
+    }
 
     bool mousePressed = sf::Mouse::isButtonPressed(sf::Mouse::Button::Left);
     if (mousePressed && !m_mouseWasPressed) {
@@ -581,21 +748,27 @@ void Othello::updateGame() {
         auto [row, col] = mouseToGridPos(mousePos);
         
         if (row >= 0 && row < 8 && col >= 0 && col < 8) {
-            m_board.updatePossibleStates();
-            std::string key = std::to_string(row) + ":" + std::to_string(col);
+            m_board.updateMoves();
             
-            if (m_board.possibleStates.find(key) != m_board.possibleStates.end()) {
+            if (const Board::Move* move = m_board.findMove(row, col)) {
                 char turn = m_board.turn;
-                m_board.place(row, col);
-                m_moveHistory.push_back(std::string(1, turn) + ": " + key);
+                m_board.play(*move);
+                m_moveHistory.push_back(std::string(1, turn) + ": " + Board::moveKey(row, col));
             }
         }
     }
     m_mouseWasPressed = mousePressed;
 
-    m_board.updatePossibleStates();
+    m_board.updateMoves();
+    
+    // a side with no move passes, unless the game is over
+    if (m_board.moves.empty() && !m_botThinking && !m_waitingForTimer && !Board::isGameOver(m_board)) {
+        char turn = m_board.turn == 'b' ? 'B' : 'W';
+        m_board.pass();
+        m_moveHistory.push_back(std::string(1, turn) + ": pass");
+    }
 
-    if (!m_paused && !m_botThinking && !m_waitingForTimer)
+    if (!m_paused && !m_botThinking && !m_waitingForTimer && !m_board.moves.empty())
         if ((m_board.turn == 'b' && m_blackEnabled) || (m_board.turn == 'w' && m_whiteEnabled))
             startBotThinking();
     
@@ -622,6 +795,11 @@ void Othello::updateGame() {
                 m_board.place(m_pendingMove.first, m_pendingMove.second);
                 m_moveHistory.push_back(std::string(1, turn) + ": " + std::to_string(m_pendingMove.first) + ":" + std::to_string(m_pendingMove.second));
                 m_pendingMove = {-1, -1};
+                
+                // think on a human opponent's time
+                bool opponentIsBot = (turn == 'B') ? m_whiteEnabled : m_blackEnabled;
+                OthelloBot& bot = (turn == 'B') ? m_blackBot : m_whiteBot;
+                if (!opponentIsBot) bot.startPondering(m_board);
             }
         }
     }
@@ -682,10 +860,9 @@ void Othello::renderGrid() {
     auto [row, col] = mouseToGridPos(mousePos);
     
     if (row >= 0 && row < 8 && col >= 0 && col < 8) {
-        m_board.updatePossibleStates();
-        std::string key = std::to_string(row) + ":" + std::to_string(col);
+        m_board.updateMoves();
         
-        if (m_board.possibleStates.find(key) != m_board.possibleStates.end()) {
+        if (m_board.findMove(row, col)) {
             sf::Color hoverColor = (m_board.turn == 'b') ? sf::Color::Black : sf::Color::White;
             hoverColor.a = 100;
             
@@ -719,20 +896,36 @@ std::pair<int, int> Othello::mouseToGridPos(sf::Vector2i mousePos) {
 
 void Othello::startBotThinking() {
     /*
-        Execute Bot turn in separate thread to not block UI
+        Hand the bot's turn to the engine worker to not block UI
     */
     m_botThinking = true;
+    m_botStop = std::stop_source();
     
-    Board::State boardCopy = m_board;
-    char currentTurn = m_board.turn;
-    
-    if (currentTurn == 'b') {
-        m_botMoveResult = std::async(std::launch::async, [this, boardCopy]() mutable {
-            return m_blackBot.getBestMove(boardCopy);
-        });
-    } else {
-        m_botMoveResult = std::async(std::launch::async, [this, boardCopy]() mutable {
-            return m_whiteBot.getBestMove(boardCopy);
-        });
+    OthelloBot& bot = (m_board.turn == 'b') ? m_blackBot : m_whiteBot;
+    m_botMoveResult = m_engine.submit(bot, m_board, m_botStop.get_token());
+}
+
+void Othello::stopBotThinking() {
+    /*
+        Stop the bot's search and drop its move, including one
+        waiting out the move delay. The search returns within a
+        few nodes of the stop request.
+    */
+    if (m_botThinking && m_botMoveResult.valid()) {
+        m_botStop.request_stop();
+        m_botMoveResult.get();
     }
+    m_botThinking = false;
+    m_waitingForTimer = false;
+    m_pendingMove = {-1, -1};
+}
+
+void Othello::stopPondering() {
+    /*
+        Stop both bots' ponder searches. The bot searching on the
+        worker is left alone until its move is in, it isn't
+        pondering anyway.
+    */
+    if (!(m_botThinking && m_board.turn == 'b')) m_blackBot.stopPondering();
+    if (!(m_botThinking && m_board.turn == 'w')) m_whiteBot.stopPondering();
 }
\ No newline at end of file
@@ -3,255 +3,965 @@
     Date: 11/04/25
     Desc: Minimax implementation wrapped in a class. Builds search tree
           as the bot explores possibilities, to use in TreeDisplay.
+          Tree recording is off unless a TreeDisplay is attached.
+          Alpha-beta runs as principal variation search (negamax,
+          null windows for all but the first move) and caches results
+          in a transposition table. With a time budget, the search
+          deepens iteratively, each iteration in an aspiration window
+          around the last one's score.
+          Alpha-beta moves are ordered by MoveOrderer.
+          With more than one thread, alpha-beta runs Lazy SMP: helper
+          threads search the same root and share the table.
+          Near the end of the game alpha-beta hands over to the exact
+          EndgameSolver. Leaves are scored by a pluggable Evaluator,
+          patterns by default. Positions in the OpeningBook are
+          played from the book without a search. Selective search
+          (Multi-ProbCut) is off by default.
+          Between moves the bot can ponder: search the position
+          after the opponent's expected reply in the background.
+          A search can be stopped through a std::stop_token, it
+          then returns the best move found so far.
 */
 
+#pragma once
+
 #include "Board.hpp"
 #include "SearchTree.hpp"
+#include "TranspositionTable.hpp"
+#include "MoveOrdering.hpp"
+#include "EndgameSolver.hpp"
+#include "PatternEvaluator.hpp"
+#include "OpeningBook.hpp"
+#include "ProbCut.hpp"
+#include <cmath>
 #include <climits>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+/*
+    Everything one search thread changes while it searches. Threads
+    share only the transposition table and the stop flag.
+*/
+struct SearchThread {
+    // moves and passes from the root
+    static constexpr int MAX_PLY = 128;
+
+    int id = 0;
+    MoveOrderer orderer;
+    size_t nodes = 0;
+    size_t hashProbes = 0;
+    size_t hashHits = 0;
+    size_t researches = 0;              // null window searches that had to be repeated
+    size_t aspirationResearches = 0;    // root searches that fell outside the window
+    size_t probCuts = 0;                // nodes cut by a shallow search
+    int completedDepth = 0;
+
+    // principal variation of the last finished iteration, and the
+    // triangular table it is collected in during an iteration
+    std::vector<int> pv;
+    int pvTable[MAX_PLY][MAX_PLY];
+    int pvLength[MAX_PLY];
+    bool followPv = false;
+
+    // tree being recorded, main thread only
+    SearchTree* tree = nullptr;
+
+    void newSearch() {
+        orderer.newSearch();
+        nodes = 0;
+        hashProbes = 0;
+        hashHits = 0;
+        researches = 0;
+        aspirationResearches = 0;
+        probCuts = 0;
+        completedDepth = 0;
+        pv.clear();
+        followPv = false;
+    }
+};
 
 class OthelloBot {
 public:
-    OthelloBot(){}
-    OthelloBot(int depth) : m_depth(depth) {}
+    OthelloBot() : OthelloBot(4) {}
+    OthelloBot(int depth) : m_depth(depth) {
+        setThreads(1);
+        m_solver.setStopFlag(&m_stop);
+    }
+    ~OthelloBot() { stopPondering(); }
 
-    void setDepth(int depth) { m_depth = depth; }
-    void toggleAlphaBeta() { m_alphaBetaOn = !m_alphaBetaOn; }
+    void setDepth(int depth) {
+        if (depth == m_depth) return;
+        stopPondering();
+        m_depth = depth;
+    }
+    void toggleAlphaBeta() { stopPondering(); m_alphaBetaOn = !m_alphaBetaOn; }
     bool alphaBetaEnabled() const { return m_alphaBetaOn; }
-    
+
+    void setTreeRecording(bool enabled) { stopPondering(); m_treeRecording = enabled; }
+    bool treeRecordingEnabled() const { return m_treeRecording; }
+
     SearchTree& getSearchTree() { return m_searchTree; }
     size_t getTreeSize() const { return m_statesExamined; }
 
+    void setHashSize(size_t megabytes) {
+        stopPondering();
+        m_tt.resize(megabytes);
+        m_solver.setHashSize(megabytes);
+    }
+    void clearHash() {
+        stopPondering();
+        m_tt.clear();
+        m_solver.clearHash();
+    }
+    double getHashHitRate() const { return m_hashHitRate; }
+    double getHashFill() const { return m_tt.fill(); }
+    
+    // repeated searches in the last search, over every thread
+    size_t getResearches() const { return m_researches; }
+    size_t getAspirationResearches() const { return m_aspirationResearches; }
+    size_t getProbCuts() const { return m_probCuts; }
+
+    /*
+        Number of search threads. Thread 0 is the caller of getBestMove,
+        the rest are helpers started for each alpha-beta search.
+    */
+    void setThreads(int count) {
+        stopPondering();
+        count = std::max(1, count);
+        m_threads.clear();
+        for (int i = 0; i < count; i++) {
+            m_threads.push_back(std::make_unique<SearchThread>());
+            m_threads.back()->id = i;
+        }
+    }
+    int getThreads() const { return static_cast<int>(m_threads.size()); }
+
+    /*
+        Per-move time budget in milliseconds. When set, getBestMove
+        deepens one ply at a time until the budget runs out instead
+        of searching to the fixed depth. 0 turns it off.
+    */
+    void setTimeBudget(int milliseconds) {
+        if (milliseconds == m_timeBudgetMs) return;
+        stopPondering();
+        m_timeBudgetMs = milliseconds;
+    }
+    int getTimeBudget() const { return m_timeBudgetMs; }
+    int getCompletedDepth() const { return m_completedDepth.load(); }
+    int getLastScore() const { return m_lastScore; }
+    const std::vector<int>& getPrincipalVariation() const { return m_threads[0]->pv; }
+    const CutoffStats& getCutoffStats() const { return m_threads[0]->orderer.stats(); }
+
+    /*
+        With alpha-beta on, positions with at most this many empty
+        squares are solved exactly. A timed search gives the solver
+        most of the budget and falls back to a normal search if it
+        runs out. 0 turns the solver off.
+    */
+    void setEndgameEmpties(int empties) { stopPondering(); m_endgameEmpties = empties; }
+    int getEndgameEmpties() const { return m_endgameEmpties; }
+    bool isSolved() const { return m_solved; }
+
+    /*
+        Leaf evaluation, shared with any other bot using the same
+        evaluator. Finished games are always scored by disc count.
+    */
+    void setEvaluator(std::shared_ptr<const Evaluator> evaluator) { stopPondering(); m_evaluator = std::move(evaluator); }
+    const Evaluator& getEvaluator() const { return *m_evaluator; }
+
     /*
-        get the best move for the current player, 
-        for the current state using minimax
+        Book checked before every search, book.bin by default.
+        nullptr turns it off.
     */
-    std::pair<int, int> getBestMove(Board::State& state) {
-        state.updatePossibleStates();
+    void setOpeningBook(std::shared_ptr<const OpeningBook> book) { stopPondering(); m_book = std::move(book); }
+    bool isBookMove() const { return m_bookMove; }
+
+    /*
+        Selective search for alpha-beta: a null window node is cut
+        when a shallow search predicts, threshold standard errors
+        out, that the full one fails too. Higher is safer and
+        slower, around 1.5 is usual. 0 turns it off. The endgame
+        solver stays exact.
+    */
+    void setProbCut(double threshold, std::shared_ptr<const ProbCut> params = ProbCut::defaultInstance()) {
+        stopPondering();
+        m_probCutThreshold = std::max(0.0, threshold);
+        m_probCut = std::move(params);
+    }
+    double getProbCut() const { return m_probCutThreshold; }
+
+    /*
+        get the best move for the current player,
+        for the current state using minimax. A stop request ends
+        the search within a few nodes, the move is then the best
+        one found so far.
+    */
+    std::pair<int, int> getBestMove(Board::State& state, std::stop_token stop = {}) {
+        state.updateMoves();
         
-        // game over
-        if (state.possibleStates.empty()) return {-1, -1};
+        // the side to move has to pass, or the game is over
+        if (state.moves.empty()) {
+            stopPondering();
+            return {-1, -1};
+        }
+        
+        // the guess was right: the ponder search carries on, now on the clock
+        if (m_ponderThread.joinable()) {
+            Board::Position pos = Board::toPosition(state);
+            if (pos.black == m_ponderPos.black && pos.white == m_ponderPos.white && pos.turn == m_ponderPos.turn) {
+                ponderHit();
+                std::stop_callback onStop(stop, [this] { m_stop = true; });
+                m_ponderThread.join();
+                m_ponderSearch = false;
+                m_searchTree.clear();
+                return m_ponderResult;
+            }
+            stopPondering();
+        }
         
+        m_completedDepth = 0;
+        m_stop = false;
+        std::stop_callback onStop(stop, [this] { m_stop = true; });
+        return search(state);
+    }
+    
+    /*
+        Search the position after the opponent's expected reply in
+        the background, until getBestMove or stopPondering. state is
+        the position after this bot's move. The reply is the second
+        move of the last PV. Needs alpha-beta, so the table can
+        carry the work over. Book and endgame positions are skipped,
+        those have their own fast paths. Changing a setting stops it.
+    */
+    void startPondering(const Board::State& state) {
+        stopPondering();
+        if (!m_alphaBetaOn) return;
+        
+        Board::Position pos = Board::toPosition(state);
+        const std::vector<int>& pv = m_threads[0]->pv;
+        if (pv.size() < 2) return;
+        
+        if (pv[1] == PASS_MOVE.square) {
+            if (!pos.mustPass()) return;
+            pos.pass();
+        }
+        else {
+            if (!(pos.legalMoves() & Board::squareBit(pv[1]))) return;
+            pos.play(pv[1], pos.flips(pv[1]));
+        }
+        
+        OpeningBook::Hit hit;
+        if (!pos.legalMoves() || (m_book && m_book->probe(pos, hit)) || std::popcount(pos.empty()) <= m_endgameEmpties)
+            return;
+        
+        // reset here, not in the thread, so a stop can't be lost
+        m_ponderPos = pos;
+        m_ponderSearch = true;
+        m_pondering = true;
+        m_completedDepth = 0;
+        m_stop = false;
+        Board::State ponderState;
+        Board::fromPosition(ponderState, pos);
+        ponderState.updateMoves();
+        m_ponderThread = std::thread([this, ponderState]() mutable {
+            m_ponderResult = search(ponderState);
+        });
+    }
+    
+    // stop a ponder search and forget it, the table keeps what it found
+    void stopPondering() {
+        if (!m_ponderThread.joinable()) return;
+        m_stop = true;
+        m_ponderThread.join();
+        m_pondering = false;
+        m_ponderSearch = false;
+    }
+    
+    bool isPondering() const { return m_pondering.load(); }
+
+private:
+    /*
+        The search behind getBestMove. A ponder search (m_ponderSearch)
+        deepens until it is stopped or hit, a fixed depth bot's no
+        further than its depth, and records no tree.
+    */
+    std::pair<int, int> search(Board::State& state) {
+        m_tt.newSearch();
+        for (auto& thread : m_threads) thread->newSearch();
+        m_searchStart = std::chrono::steady_clock::now();
+        
+        // one position is walked down and back up the whole tree
+        Board::Position pos = Board::toPosition(state);
+        
+        m_bookMove = false;
+        m_solved = false;
+        OpeningBook::Hit hit;
+        if (!m_ponderSearch && m_book && m_book->probe(pos, hit)) return playBookMove(pos, hit);
+        
+        m_searchBudgetMs = m_timeBudgetMs;
+        if (!m_ponderSearch && m_alphaBetaOn && std::popcount(pos.empty()) <= m_endgameEmpties) {
+            if (solveEndgame(pos)) return {m_threads[0]->pv[0] / 8, m_threads[0]->pv[0] % 8};
+            
+            // out of time, the normal search gets what is left
+            if (m_timeBudgetMs > 0) {
+                m_searchBudgetMs = std::max(1LL, m_timeBudgetMs - elapsedMs());
+                m_searchStart = std::chrono::steady_clock::now();
+            }
+        }
+        
+        // iterative deepening stops once every empty square is searched
+        bool deepen = m_timeBudgetMs > 0 || m_ponderSearch;
+        int maxDepth = deepen ? std::popcount(pos.empty()) : m_depth;
+        
+        // helpers only pay off when they can share the table
+        std::vector<std::thread> helpers;
+        if (m_alphaBetaOn) {
+            for (size_t i = 1; i < m_threads.size(); i++) {
+                helpers.emplace_back([this, &state, pos, maxDepth, i]() mutable {
+                    helperSearch(*m_threads[i], pos, state.moves, maxDepth);
+                });
+            }
+        }
+        
+        SearchThread& main = *m_threads[0];
+        Board::MoveList rootMoves = state.moves;
+        int bestMove = rootMoves[0].square;
+        
+        // fixed depth search
+        if (!deepen) {
+            if (m_alphaBetaOn) main.orderer.order(rootMoves, pos, 0, m_depth, -1, hashMove(pos));
+            auto [move, value] = searchRoot(main, pos, rootMoves, m_depth);
+            
+            // stopped before a root move was done: the first in order
+            bestMove = (move >= 0) ? move : rootMoves[0].square;
+            if (move >= 0) m_lastScore = value;
+            if (!stopped()) m_completedDepth = m_depth;
+        }
+        
+        // iterative deepening
+        else {
+            // scores swing between odd and even depths, the window is
+            // centered on the last one of the same parity
+            int scores[2] = {};
+            for (int depth = 1; depth <= maxDepth; depth++) {
+                // previous best move first
+                if (m_alphaBetaOn) main.orderer.order(rootMoves, pos, 0, depth, bestMove, hashMove(pos));
+                
+                auto [move, value] = (m_alphaBetaOn && depth > 1)
+                    ? aspirationSearch(main, pos, rootMoves, depth, scores[depth > 2 ? depth % 2 : 1])
+                    : searchRoot(main, pos, rootMoves, depth);
+                if (stopped()) break;
+                
+                bestMove = move;
+                scores[depth % 2] = value;
+                m_lastScore = value;
+                m_completedDepth = depth;
+                
+                // still pondering on a clock, keep deepening
+                if (m_pondering && m_timeBudgetMs > 0) continue;
+                
+                // a fixed depth ponder (hit or not) is done at that depth
+                if (m_timeBudgetMs <= 0) {
+                    if (depth >= m_depth) break;
+                    continue;
+                }
+                
+                // the next iteration takes several times longer, don't start
+                // one that has no chance of finishing
+                if (elapsedMs() * 2 >= m_searchBudgetMs) break;
+            }
+        }
+        
+        m_stop = true;
+        for (auto& helper : helpers) helper.join();
+        
+        // totals over every thread
+        size_t probes = 0, hits = 0;
+        m_statesExamined = 0;
+        m_researches = 0;
+        m_aspirationResearches = 0;
+        m_probCuts = 0;
+        for (auto& thread : m_threads) {
+            m_statesExamined += thread->nodes;
+            probes += thread->hashProbes;
+            hits += thread->hashHits;
+            m_researches += thread->researches;
+            m_aspirationResearches += thread->aspirationResearches;
+            m_probCuts += thread->probCuts;
+        }
+        m_hashHitRate = probes ? static_cast<double>(hits) / probes : 0.0;
+        
+        m_searchTree.setSize(m_statesExamined);
+        return {bestMove / 8, bestMove % 8};
+    }
+    
+    void ponderHit() {
+        /*
+            Turn the running ponder search into a normal one: the
+            clock starts now. A fixed depth search that already got
+            there stops at once.
+        */
+        m_searchStart = std::chrono::steady_clock::now();
+        m_searchBudgetMs = m_timeBudgetMs;
+        m_pondering = false;
+        if (m_timeBudgetMs <= 0 && m_completedDepth >= m_depth) m_stop = true;
+    }
+    
+    static constexpr int MAX_PLY = SearchThread::MAX_PLY;
+    
+    // final disc counts are within SCORE_MAX, SCORE_INF is beyond any score
+    static constexpr int SCORE_MAX = 64;
+    static constexpr int SCORE_INF = 1 << 20;
+    
+    // half width of the first aspiration window, in discs
+    static constexpr int ASPIRATION_WINDOW = 2;
+    
+    // stands in for a pass in the tree and the PV
+    static constexpr Board::Move PASS_MOVE = {-1, 0};
+
+    int m_depth = 4;
+    bool m_alphaBetaOn = false;
+    bool m_treeRecording = false;
+    SearchTree m_searchTree;
+    SearchTree m_recordTree;            // the iteration being searched, swapped in when it finishes
+    TranspositionTable m_tt;
+    std::vector<std::unique_ptr<SearchThread>> m_threads;
+    size_t m_statesExamined = 0;
+    double m_hashHitRate = 0.0;
+    size_t m_researches = 0;
+    size_t m_aspirationResearches = 0;
+    size_t m_probCuts = 0;
+
+    int m_timeBudgetMs = 0;
+    // read by the search threads, written by a ponder hit
+    std::atomic<long long> m_searchBudgetMs = 0;     // what is left of the budget for alpha-beta
+    std::atomic<std::chrono::steady_clock::time_point> m_searchStart;
+    std::atomic<bool> m_stop = false;
+    std::atomic<int> m_completedDepth = 0;
+    int m_lastScore = 0;
+    
+    EndgameSolver m_solver;
+    int m_endgameEmpties = EndgameSolver::DEFAULT_EMPTIES;
+    bool m_solved = false;
+    
+    std::shared_ptr<const Evaluator> m_evaluator = PatternEvaluator::defaultInstance();
+    
+    std::shared_ptr<const OpeningBook> m_book = OpeningBook::defaultInstance();
+    
+    double m_probCutThreshold = 0.0;
+    std::shared_ptr<const ProbCut> m_probCut = ProbCut::defaultInstance();
+    bool m_bookMove = false;
+    
+    std::thread m_ponderThread;
+    Board::Position m_ponderPos;                // position being pondered
+    std::pair<int, int> m_ponderResult = {-1, -1};
+    bool m_ponderSearch = false;                // the running search started as a ponder
+    std::atomic<bool> m_pondering = false;      // ... and has not been hit yet
+    
+    std::pair<int, int> playBookMove(const Board::Position& pos, const OpeningBook::Hit& hit) {
+        /*
+            Report a book move like a finished search with no
+            nodes and no tree
+        */
+        m_lastScore = (pos.turn == 'w') ? hit.score : -hit.score;
+        m_threads[0]->pv = {hit.move};
         m_statesExamined = 0;
+        m_hashHitRate = 0.0;
+        m_bookMove = true;
+        m_searchTree.clear();
+        m_searchTree.setSize(0);
+        return {hit.move / 8, hit.move % 8};
+    }
+    
+    bool solveEndgame(const Board::Position& pos) {
+        /*
+            Solve to the end of the game. On success the result is
+            stored like a finished search (score, PV, node count)
+            and the tree is just the root. Returns false if the
+            solver ran out of time.
+        */
+        int budget = (m_timeBudgetMs > 0) ? std::max(1, m_timeBudgetMs * 3 / 4) : 0;
+        EndgameSolver::Result result = m_solver.solve(pos, budget);
+        if (!result.solved) return false;
+        
+        // the solver scores for the side to move, the bot white - black
+        m_lastScore = (pos.turn == 'w') ? result.score : -result.score;
+        m_completedDepth = std::popcount(pos.empty());
+        m_threads[0]->pv = {result.move};
+        m_statesExamined = result.nodes;
+        m_hashHitRate = 0.0;
+        m_solved = true;
         
+        m_searchTree.clear();
+        if (m_treeRecording) {
+            SearchNode root = treeNode(PASS_MOVE, pos, m_completedDepth, pos.turn == 'w');
+            root.heuristic = m_lastScore;
+            m_searchTree.add(SearchTree::NONE, root);
+            m_searchTree.finish();
+        }
+        m_searchTree.setSize(m_statesExamined);
+        return true;
+    }
+
+    void helperSearch(SearchThread& thread, Board::Position pos, Board::MoveList rootMoves, int maxDepth) {
+        /*
+            Lazy SMP helper. Deepens on its own until the main thread
+            is done, odd threads one ply ahead so the threads spread
+            over two depths and fill the table for each other.
+        */
+        int bestMove = -1;
+        int scores[2] = {};
+        int firstDepth = 1 + thread.id % 2;
+        for (int depth = firstDepth; depth <= maxDepth + 1 && !stopped(); depth++) {
+            thread.orderer.order(rootMoves, pos, 0, depth, bestMove, hashMove(pos));
+            int previous = scores[(depth - 2 >= firstDepth) ? depth % 2 : 1 - depth % 2];
+            auto [move, value] = (depth > firstDepth) ? aspirationSearch(thread, pos, rootMoves, depth, previous)
+                                                      : searchRoot(thread, pos, rootMoves, depth);
+            if (stopped()) break;
+            bestMove = move;
+            scores[depth % 2] = value;
+            thread.completedDepth = depth;
+        }
+    }
+
+    /*
+        Search every root move to depth. Returns the best square and
+        its value. On a finished iteration the search tree and PV are
+        replaced, an iteration cut short by the clock changes nothing.
+        Alpha-beta searches in the window (alpha, beta), for the side
+        to move. A value outside it is only a bound, and then the
+        tree and PV are left alone too.
+    */
+    std::pair<int, int> searchRoot(SearchThread& thread, Board::Position& pos, const Board::MoveList& rootMoves, int depth,
+                                   int alpha = -SCORE_INF, int beta = SCORE_INF) {
         // the root of the search tree, will be used in TreeDisplay
-        auto searchRoot = std::make_shared<SearchNode>();
-        searchRoot->turn = state.turn;
-        searchRoot->whiteScore = state.white;
-        searchRoot->blackScore = state.black;
-        searchRoot->depth = m_depth;
-        searchRoot->maximizing = (state.turn == 'w');
-        searchRoot->moveSequence = "Root";
-        
-        m_searchTree.setRoot(searchRoot);
-        m_statesExamined++;
-        
-        // white player is maximizing eval (white - black)
-        bool maximizing = (state.turn == 'w');
-        int bestValue = maximizing ? INT_MIN : INT_MAX;
-        std::pair<int, int> bestMove = {-1, -1};
-        
-        for (auto& [key, nextState] : state.possibleStates) {
+        SearchTree::Index searchRoot = SearchTree::NONE;
+        thread.tree = nullptr;
+        if (m_treeRecording && thread.id == 0 && !m_ponderSearch) {
+            m_recordTree.clear();
+            searchRoot = m_recordTree.add(SearchTree::NONE, treeNode(PASS_MOVE, pos, depth, pos.turn == 'w'));
+            thread.tree = &m_recordTree;
+        }
+        thread.nodes++;
+        
+        // values are for the side to move here, white - black outside
+        bool maximizing = (pos.turn == 'w');
+        int sign = maximizing ? 1 : -1;
+        int bestValue = -SCORE_INF;
+        int bestMove = -1;
+        thread.pvLength[0] = 0;
+        
+        for (int i = 0; i < rootMoves.size(); i++) {
+            const Board::Move& move = rootMoves[i];
+            pos.makeMove(move);
+            
             // create a search node for every possible state
-            auto childNode = std::make_shared<SearchNode>();
-            size_t colonPos = key.find(':');
-            childNode->row = std::stoi(key.substr(0, colonPos));
-            childNode->col = std::stoi(key.substr(colonPos + 1));
-            childNode->turn = nextState.turn;
-            childNode->whiteScore = nextState.white;
-            childNode->blackScore = nextState.black;
-            childNode->depth = m_depth - 1;
-            childNode->maximizing = !maximizing;
-            childNode->moveSequence = key;
+            SearchTree::Index childNode = recordChild(thread, searchRoot, move, pos, depth - 1, !maximizing);
             
-            // determine which minimax function to call (alpha-beta on/off)
+            // the first root move leads the previous principal variation
+            thread.followPv = (i == 0 && !thread.pv.empty() && thread.pv[0] == move.square);
+            thread.pvLength[1] = 1;
+            
+            // determine which search to call (alpha-beta on/off)
+            // later root moves only need to prove they beat the best so far
             int eval;
-            if (m_alphaBetaOn) eval = minimax(nextState, childNode, m_depth - 1, !maximizing, INT_MIN, INT_MAX);
-            else eval = minimax(nextState, childNode, m_depth - 1, !maximizing);
+            if (m_alphaBetaOn) {
+                int floor = std::max(alpha, bestValue);
+                eval = (i == 0) ? -negamax(thread, pos, childNode, depth - 1, 1, -beta, -floor)
+                                : scout(thread, pos, childNode, depth - 1, 1, floor, beta);
+            }
+            else eval = sign * minimax(thread, pos, childNode, depth - 1, !maximizing);
             
-            // update search node with eval, add it to the tree
-            childNode->heuristic = eval;
-            searchRoot->children.push_back(childNode);
+            pos.undoMove(move);
+            if (stopped()) return {bestMove, sign * bestValue};
             
-            if ((maximizing && eval > bestValue) || (!maximizing && eval < bestValue)) {
+            if (eval > bestValue) {
                 bestValue = eval;
-                bestMove = {childNode->row, childNode->col};
+                bestMove = move.square;
+                updatePv(thread, 0, move.square);
             }
+            if (m_alphaBetaOn && bestValue >= beta) break;
         }
         
-        // update heuristic, and number of states explored
-        searchRoot->heuristic = bestValue;
-        m_searchTree.setSize(m_statesExamined);
-        return bestMove;
+        // keep the root result for the next search, exact inside the window
+        bool exact = !m_alphaBetaOn || (bestValue > alpha && bestValue < beta);
+        if (m_alphaBetaOn)
+            storeResult(pos.hash, depth, bestValue, alpha, beta, bestMove);
+        if (!exact) return {bestMove, sign * bestValue};
+        
+        // update heuristic, keep the finished iteration's tree and PV
+        if (thread.id == 0 && !m_ponderSearch) {
+            m_searchTree.clear();
+            if (thread.tree) {
+                setHeuristic(thread, searchRoot, sign * bestValue);
+                m_recordTree.finish();
+                std::swap(m_searchTree, m_recordTree);
+            }
+        }
+        thread.pv.assign(thread.pvTable[0], thread.pvTable[0] + thread.pvLength[0]);
+        return {bestMove, sign * bestValue};
+    }
+    
+    /*
+        Root search in a window around the last iteration's score
+        (white - black). A result outside the window is only a bound:
+        the window is widened on that side, twice as far each time,
+        and the depth searched again, best move first.
+    */
+    std::pair<int, int> aspirationSearch(SearchThread& thread, Board::Position& pos, Board::MoveList rootMoves, int depth, int previous) {
+        int sign = (pos.turn == 'w') ? 1 : -1;
+        int delta = ASPIRATION_WINDOW;
+        int alpha = sign * previous - delta;
+        int beta = sign * previous + delta;
+        
+        while (true) {
+            auto [move, value] = searchRoot(thread, pos, rootMoves, depth, alpha, beta);
+            int score = sign * value;
+            if (stopped() || (score > alpha && score < beta)) return {move, value};
+            
+            thread.aspirationResearches++;
+            delta *= 2;
+            if (score <= alpha) alpha = (delta > SCORE_MAX) ? -SCORE_INF : score - delta;
+            else {
+                beta = (delta > SCORE_MAX) ? SCORE_INF : score + delta;
+                thread.orderer.order(rootMoves, pos, 0, depth, move, hashMove(pos));
+            }
+        }
     }
 
-private:
-    int m_depth = 4;
-    bool m_alphaBetaOn = false;
-    SearchTree m_searchTree;
-    size_t m_statesExamined = 0;
+    long long elapsedMs() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - m_searchStart.load()).count();
+    }
+
+    bool stopped() const { return m_stop.load(std::memory_order_relaxed); }
+
+    bool outOfTime(SearchThread& thread) {
+        /*
+            Only timed searches stop early, and only the main thread
+            watches the clock. It is read every 1024 states to keep
+            it out of the hot path.
+        */
+        if (thread.id == 0 && m_timeBudgetMs > 0 && (thread.nodes & 1023) == 0 && !m_pondering && elapsedMs() >= m_searchBudgetMs)
+            m_stop = true;
+        return stopped();
+    }
+
+    void updatePv(SearchThread& thread, int ply, int square) {
+        /*
+            square is the new best move at ply, its line continues
+            with the principal variation found below it
+        */
+        thread.pvTable[ply][ply] = square;
+        int childLength = (ply + 1 < MAX_PLY) ? thread.pvLength[ply + 1] : ply + 1;
+        for (int i = ply + 1; i < childLength; i++)
+            thread.pvTable[ply][i] = thread.pvTable[ply + 1][i];
+        thread.pvLength[ply] = std::max(childLength, ply + 1);
+    }
+
+    int hashMove(const Board::Position& pos) {
+        TTEntry entry;
+        return m_tt.probe(pos.hash, entry) ? entry.bestMove : -1;
+    }
+
+    // tree node for the position after move (PASS_MOVE for none)
+    static SearchNode treeNode(const Board::Move& move, const Board::Position& pos, int depth, bool maximizing) {
+        SearchNode node;
+        node.square = static_cast<int8_t>(move.square == PASS_MOVE.square ? -1 : move.square);
+        node.turn = pos.turn;
+        node.whiteScore = static_cast<uint8_t>(pos.whiteCount());
+        node.blackScore = static_cast<uint8_t>(pos.blackCount());
+        node.depth = static_cast<int8_t>(depth);
+        node.maximizing = maximizing;
+        return node;
+    }
 
     /*
-        minimax without alpha-beta pruning
+        Add a search tree node for move under parent. pos is the
+        position after the move. Returns NONE, and does no work,
+        when the tree is not being recorded (parent is NONE).
     */
-    int minimax(Board::State state, std::shared_ptr<SearchNode> node, int depth, bool maximizing) {
-        m_statesExamined++;
+    SearchTree::Index recordChild(SearchThread& thread, SearchTree::Index parent, const Board::Move& move, const Board::Position& pos, int depth, bool maximizing) {
+        if (parent == SearchTree::NONE) return SearchTree::NONE;
+        return thread.tree->add(parent, treeNode(move, pos, depth, maximizing));
+    }
+
+    // scores are within the disc range, they fit the node
+    void setHeuristic(SearchThread& thread, SearchTree::Index node, int value) {
+        if (node != SearchTree::NONE) thread.tree->node(node).heuristic = static_cast<int16_t>(value);
+    }
+
+    /*
+        Store a node's result. A score at or below the original alpha is
+        only an upper bound, at or above the original beta a lower bound.
+    */
+    void storeResult(uint64_t hash, int depth, int score, int alphaOrig, int betaOrig, int bestMove) {
+        Bound bound = Bound::EXACT;
+        if (score <= alphaOrig) bound = Bound::UPPER;
+        else if (score >= betaOrig) bound = Bound::LOWER;
+        m_tt.store(hash, depth, bound, score, bestMove);
+    }
+
+    /*
+        minimax without alpha-beta pruning. pos is made/unmade in
+        place, it is back to its original state on return.
+    */
+    int minimax(SearchThread& thread, Board::Position& pos, SearchTree::Index node, int depth, bool maximizing) {
+        thread.nodes++;
+        if (outOfTime(thread)) return 0;
         
         // reached max depth
         if (depth == 0) {
-            int eval = state.white - state.black;
-            node->heuristic = eval;
+            int eval = m_evaluator->evaluate(pos);
+            setHeuristic(thread, node, eval);
             return eval;
         }
         
         // update with all possible moves for the state
-        state.updatePossibleStates();
+        Board::MoveList moves;
+        pos.generateMoves(moves);
         
-        // game over
-        if (state.possibleStates.empty()) {
-            int eval = state.white - state.black;
-            node->heuristic = eval;
+        // no move: pass if the opponent can move, otherwise the game is over
+        if (moves.empty()) {
+            int eval;
+            if (pos.mustPass()) {
+                pos.pass();
+                SearchTree::Index childNode = recordChild(thread, node, PASS_MOVE, pos, depth, !maximizing);
+                eval = minimax(thread, pos, childNode, depth, !maximizing);
+                pos.pass();
+            }
+            else eval = pos.finalScore();
+            setHeuristic(thread, node, eval);
             return eval;
         }
         
         // white move
         if (maximizing) {
             int maxEval = INT_MIN;
-            for (auto& [key, nextState] : state.possibleStates) {
+            for (const Board::Move& move : moves) {
+                pos.makeMove(move);
+                
                 // create search tree node
-                auto childNode = std::make_shared<SearchNode>();
-                size_t colonPos = key.find(':');
-                childNode->row = std::stoi(key.substr(0, colonPos));
-                childNode->col = std::stoi(key.substr(colonPos + 1));
-                childNode->turn = nextState.turn;
-                childNode->whiteScore = nextState.white;
-                childNode->blackScore = nextState.black;
-                childNode->depth = depth;
-                childNode->maximizing = false;
-                childNode->moveSequence = node->moveSequence + " -> " + key;
+                SearchTree::Index childNode = recordChild(thread, node, move, pos, depth, false);
                 
-                // recursive call to minimax, update heuristic, add node to tree
-                int eval = minimax(nextState, childNode, depth - 1, false);
-                childNode->heuristic = eval;
-                node->children.push_back(childNode);
+                // recursive call to minimax
+                int eval = minimax(thread, pos, childNode, depth - 1, false);
+                pos.undoMove(move);
+                if (stopped()) return 0;
                 maxEval = std::max(maxEval, eval);
             }
-            node->heuristic = maxEval;
+            setHeuristic(thread, node, maxEval);
             return maxEval;
-        } 
+        }
         
         // black move
         else {
             int minEval = INT_MAX;
-            for (auto& [key, nextState] : state.possibleStates) {
+            for (const Board::Move& move : moves) {
+                pos.makeMove(move);
+                
                 // create search tree node
-                auto childNode = std::make_shared<SearchNode>();
-                size_t colonPos = key.find(':');
-                childNode->row = std::stoi(key.substr(0, colonPos));
-                childNode->col = std::stoi(key.substr(colonPos + 1));
-                childNode->turn = nextState.turn;
-                childNode->whiteScore = nextState.white;
-                childNode->blackScore = nextState.black;
-                childNode->depth = depth;
-                childNode->maximizing = true;
-                childNode->moveSequence = node->moveSequence + " -> " + key;
+                SearchTree::Index childNode = recordChild(thread, node, move, pos, depth, true);
                 
-                // recursive call to minimax, update heuristic, add node to tree
-                int eval = minimax(nextState, childNode, depth - 1, true);
-                childNode->heuristic = eval;
-                node->children.push_back(childNode);
+                // recursive call to minimax
+                int eval = minimax(thread, pos, childNode, depth - 1, true);
+                pos.undoMove(move);
+                if (stopped()) return 0;
                 minEval = std::min(minEval, eval);
             }
-            node->heuristic = minEval;
+            setHeuristic(thread, node, minEval);
             return minEval;
         }
     }
 
     /*
-        minimax with alpha-beta pruning
+        Multi-ProbCut test of a null window node (alpha, alpha + 1).
+        The depth's regression predicts the full search's score from
+        a shallow one. Each side is checked with a null window search
+        at the shallow score that puts the prediction threshold
+        standard errors past the window. On a cut, score is the bound
+        the node fails to. The shallow searches record no tree.
     */
-    int minimax(Board::State state, std::shared_ptr<SearchNode> node, int depth, bool maximizing, int alpha, int beta) {
-        m_statesExamined++;
-
+    bool probCut(SearchThread& thread, Board::Position& pos, int depth, int ply, int alpha, int& score) {
+        const ProbCut::Params& params = m_probCut->params(Pattern::phase(pos), depth);
+        int shallow = ProbCut::shallowDepth(depth);
+        double margin = m_probCutThreshold * params.sigma;
+        int beta = alpha + 1;
+        
+        // fails high: a * v + b >= beta + margin
+        int high = static_cast<int>(std::ceil((beta + margin - params.b) / params.a));
+        if (high <= SCORE_MAX) {
+            int value = negamax(thread, pos, SearchTree::NONE, shallow, ply, high - 1, high);
+            if (stopped()) return false;
+            if (value >= high) {
+                thread.probCuts++;
+                score = beta;
+                return true;
+            }
+        }
+        
+        // fails low: a * v + b <= alpha - margin
+        int low = static_cast<int>(std::floor((alpha - margin - params.b) / params.a));
+        if (low >= -SCORE_MAX) {
+            int value = negamax(thread, pos, SearchTree::NONE, shallow, ply, low, low + 1);
+            if (stopped()) return false;
+            if (value <= low) {
+                thread.probCuts++;
+                score = alpha;
+                return true;
+            }
+        }
+        
+        // the shallow searches wrote their own PV here
+        thread.pvLength[ply] = ply;
+        return false;
+    }
+    
+    /*
+        Null window search of a later move at the node above, whose
+        best so far is alpha: proves the move no better, or finds it
+        is and searches it again with the full window. pos is the
+        position after the move. Returns the value for the side that
+        made it.
+    */
+    int scout(SearchThread& thread, Board::Position& pos, SearchTree::Index node, int depth, int ply, int alpha, int beta) {
+        int eval = -negamax(thread, pos, node, depth, ply, -alpha - 1, -alpha);
+        if (eval > alpha && eval < beta && !stopped()) {
+            thread.researches++;
+            if (node != SearchTree::NONE) thread.tree->clearChildren(node);
+            eval = -negamax(thread, pos, node, depth, ply, -beta, -alpha);
+        }
+        return eval;
+    }
+    
+    /*
+        Principal variation search: negamax with alpha-beta pruning.
+        Scores are for the side to move, table entries too. The first
+        move gets the full window, the rest a null window (see scout).
+        ply is the distance from the root, used for the PV. The tree
+        keeps white - black scores.
+    */
+    int negamax(SearchThread& thread, Board::Position& pos, SearchTree::Index node, int depth, int ply, int alpha, int beta) {
+        thread.nodes++;
+        if (outOfTime(thread)) return 0;
+        
+        thread.pvLength[ply] = ply;
+        int sign = (pos.turn == 'w') ? 1 : -1;
+        
+        // only the first move of a node on the previous PV stays on it
+        int pvMove = -1;
+        bool onPv = thread.followPv;
+        if (thread.followPv) {
+            thread.followPv = false;
+            if (ply < static_cast<int>(thread.pv.size())) pvMove = thread.pv[ply];
+        }
+        
         // reached max depth
         if (depth == 0) {
-            int eval = state.white - state.black;
-            node->heuristic = eval;
+            int eval = sign * m_evaluator->evaluate(pos);
+            setHeuristic(thread, node, sign * eval);
             return eval;
         }
-
+        
+        // a stored result at least this deep may settle the node outright
+        int alphaOrig = alpha;
+        int betaOrig = beta;
+        int hashMove = -1;
+        TTEntry entry;
+        thread.hashProbes++;
+        if (m_tt.probe(pos.hash, entry)) {
+            thread.hashHits++;
+            hashMove = entry.bestMove;
+            if (entry.depth >= depth) {
+                if (entry.bound == Bound::EXACT) {
+                    setHeuristic(thread, node, sign * entry.score);
+                    return entry.score;
+                }
+                if (entry.bound == Bound::LOWER) alpha = std::max(alpha, static_cast<int>(entry.score));
+                if (entry.bound == Bound::UPPER) beta = std::min(beta, static_cast<int>(entry.score));
+                if (beta <= alpha) {
+                    setHeuristic(thread, node, sign * entry.score);
+                    return entry.score;
+                }
+            }
+        }
+        
+        // selective search, off the principal variation only
+        if (m_probCutThreshold > 0 && beta == alpha + 1 && depth >= ProbCut::MIN_DEPTH) {
+            int cut;
+            if (probCut(thread, pos, depth, ply, alpha, cut)) {
+                setHeuristic(thread, node, sign * cut);
+                return cut;
+            }
+            if (stopped()) return 0;
+        }
+        
         // update with all possible moves for the state
-        state.updatePossibleStates();
+        Board::MoveList moves;
+        pos.generateMoves(moves);
+        
+        // previous PV move, hash move, killers, then history and square weights
+        thread.orderer.order(moves, pos, ply, depth, pvMove, hashMove);
         
-        // game over
-        if (state.possibleStates.empty()) {
-            int eval = state.white - state.black;
-            node->heuristic = eval;
+        // no move: pass if the opponent can move, otherwise the game is over.
+        // A pass costs no depth, two in a row can't happen.
+        if (moves.empty()) {
+            int eval;
+            if (pos.mustPass()) {
+                pos.pass();
+                SearchTree::Index childNode = recordChild(thread, node, PASS_MOVE, pos, depth, pos.turn == 'w');
+                thread.followPv = onPv && pvMove == PASS_MOVE.square && ply < static_cast<int>(thread.pv.size());
+                eval = -negamax(thread, pos, childNode, depth, ply + 1, -beta, -alpha);
+                pos.pass();
+                if (stopped()) return 0;
+                updatePv(thread, ply, PASS_MOVE.square);
+            }
+            else eval = sign * pos.finalScore();
+            setHeuristic(thread, node, sign * eval);
             return eval;
         }
         
-        // white move
-        if (maximizing) {
-            int maxEval = INT_MIN;
-            for (auto& [key, nextState] : state.possibleStates) {
-                // create search tree node
-                auto childNode = std::make_shared<SearchNode>();
-                size_t colonPos = key.find(':');
-                childNode->row = std::stoi(key.substr(0, colonPos));
-                childNode->col = std::stoi(key.substr(colonPos + 1));
-                childNode->turn = nextState.turn;
-                childNode->whiteScore = nextState.white;
-                childNode->blackScore = nextState.black;
-                childNode->depth = depth;
-                childNode->maximizing = false;
-                childNode->moveSequence = node->moveSequence + " -> " + key;
-                
-                // recursive call to minimax, update heuristic, add node to tree
-                int eval = minimax(nextState, childNode, depth - 1, false, alpha, beta);
-                childNode->heuristic = eval;
-                node->children.push_back(childNode);
-                maxEval = std::max(maxEval, eval);
-                
-                // update alpha (best value white can guarantee)
-                alpha = std::max(alpha, eval);
-                
-                // prune if black can already guarantee better elsewhere
-                if (beta <= alpha) break;
-            }
-            node->heuristic = maxEval;
-            return maxEval;
-        } 
+        thread.orderer.recordNode(depth);
         
-        // black move
-        else {
-            int minEval = INT_MAX;
-            for (auto& [key, nextState] : state.possibleStates) {
-                // create search tree node
-                auto childNode = std::make_shared<SearchNode>();
-                size_t colonPos = key.find(':');
-                childNode->row = std::stoi(key.substr(0, colonPos));
-                childNode->col = std::stoi(key.substr(colonPos + 1));
-                childNode->turn = nextState.turn;
-                childNode->whiteScore = nextState.white;
-                childNode->blackScore = nextState.black;
-                childNode->depth = depth;
-                childNode->maximizing = true;
-                childNode->moveSequence = node->moveSequence + " -> " + key;
-                
-                // recursive call to minimax, update heuristic, add node to tree
-                int eval = minimax(nextState, childNode, depth - 1, true, alpha, beta);
-                childNode->heuristic = eval;
-                node->children.push_back(childNode);
-                minEval = std::min(minEval, eval);
-                
-                // update beta (best value black can guarantee)
-                beta = std::min(beta, eval);
-                
-                // prune if white can already guarantee better elsewhere
-                if (beta <= alpha) break;
+        int bestValue = -SCORE_INF;
+        int bestMove = -1;
+        for (int i = 0; i < moves.size(); i++) {
+            const Board::Move& move = moves[i];
+            pos.makeMove(move);
+            
+            // create search tree node
+            SearchTree::Index childNode = recordChild(thread, node, move, pos, depth, pos.turn == 'w');
+            
+            // the first move gets the full window, the rest are scouted
+            int eval;
+            if (i == 0) {
+                thread.followPv = (move.square == pvMove);
+                eval = -negamax(thread, pos, childNode, depth - 1, ply + 1, -beta, -alpha);
+            }
+            else eval = scout(thread, pos, childNode, depth - 1, ply + 1, alpha, beta);
+            
+            pos.undoMove(move);
+            if (stopped()) return 0;
+            if (eval > bestValue) {
+                bestValue = eval;
+                bestMove = move.square;
+                updatePv(thread, ply, move.square);
+            }
+            
+            // prune if the opponent can already guarantee better elsewhere
+            alpha = std::max(alpha, eval);
+            if (alpha >= beta) {
+                thread.orderer.recordCutoff(pos, move.square, ply, depth, i);
+                break;
             }
-            node->heuristic = minEval;
-            return minEval;
         }
+        storeResult(pos.hash, depth, bestValue, alphaOrig, betaOrig, bestMove);
+        setHeuristic(thread, node, sign * bestValue);
+        return bestValue;
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,440 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Pattern evaluation. The board is cut into fixed groups of
+          squares (edges, 3x3 and 2x5 corners, long diagonals), each
+          group's contents read as a base-3 number (0 empty, 1 white,
+          2 black) and used to index a weight table. There is one
+          set of tables per game phase (disc count).
+
+          Every pattern is read from the a1 corner of one of the 8
+          mirrored/rotated copies of the board. A pattern's squares
+          are packed into a small bitmask and turned into base-3
+          digits with one table lookup, no per-square loop.
+
+          Weights start from the static square values. Trained
+          weights (tools/train.cpp) are memory-mapped from a weight
+          file, weights.bin in the working directory is picked up
+          by defaultInstance().
+*/
+
+#pragma once
+
+#include "Evaluator.hpp"
+#include "MoveOrdering.hpp"
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Pattern {
+
+enum Type { EDGE, CORNER_3X3, CORNER_2X5, DIAGONAL, TYPE_COUNT };
+
+// squares in each pattern and how many copies are on the board
+constexpr int SIZE[TYPE_COUNT] = {8, 9, 10, 8};
+constexpr int COPIES[TYPE_COUNT] = {4, 4, 8, 2};
+constexpr int INSTANCES = 4 + 4 + 8 + 2;
+
+constexpr int pow3(int n) { return n == 0 ? 1 : 3 * pow3(n - 1); }
+
+// start of each pattern's table within a phase
+constexpr int OFFSET[TYPE_COUNT + 1] = {
+    0,
+    pow3(8),
+    pow3(8) + pow3(9),
+    pow3(8) + pow3(9) + pow3(10),
+    pow3(8) + pow3(9) + pow3(10) + pow3(8),
+};
+constexpr int PHASE_SIZE = OFFSET[TYPE_COUNT];
+
+// one bucket for every 4 discs played
+constexpr int PHASES = 15;
+
+inline int phase(Board::Bitboard black, Board::Bitboard white) {
+    int played = std::popcount(black | white) - 4;
+    return std::clamp(played / 4, 0, PHASES - 1);
+}
+
+inline int phase(const Board::Position& pos) { return phase(pos.black, pos.white); }
+
+// binary to base-3: bit i of the index becomes digit i (value 1)
+constexpr std::array<uint16_t, 1024> makeTernary() {
+    std::array<uint16_t, 1024> table = {};
+    for (int bits = 0; bits < 1024; bits++)
+        for (int i = 0; i < 10; i++)
+            if (bits & (1 << i)) table[bits] += pow3(i);
+    return table;
+}
+inline constexpr std::array<uint16_t, 1024> TERNARY = makeTernary();
+
+/*
+    Each gather packs one pattern's squares into the low bits, in
+    digit order. The base-3 index is then one lookup per color,
+    white digits 1 and black digits 2.
+*/
+inline int ternary(int white, int black) { return TERNARY[white] + 2 * TERNARY[black]; }
+
+inline int gatherEdge(Board::Bitboard b) { return b & 0xff; }
+
+inline int gatherCorner3x3(Board::Bitboard b) {
+    return (b & 0x7) | ((b >> 5) & 0x38) | ((b >> 10) & 0x1c0);
+}
+
+inline int gatherCorner2x5(Board::Bitboard b) {
+    return (b & 0x1f) | ((b >> 3) & 0x3e0);
+}
+
+inline int gatherDiagonal(Board::Bitboard b) {
+    // multiplying stacks the a1-h8 diagonal into the top byte
+    return ((b & 0x8040201008040201ULL) * 0x0101010101010101ULL) >> 56;
+}
+
+/*
+    Table index of every pattern copy on the board, with the
+    pattern's offset already added
+*/
+inline void indices(Board::Bitboard whitePieces, Board::Bitboard blackPieces, int out[INSTANCES]) {
+    Board::Bitboard white[8], black[8];
+    white[0] = whitePieces;
+    black[0] = blackPieces;
+    white[1] = Board::flipVertical(white[0]);
+    black[1] = Board::flipVertical(black[0]);
+    white[2] = Board::mirrorHorizontal(white[0]);
+    black[2] = Board::mirrorHorizontal(black[0]);
+    white[3] = Board::flipVertical(white[2]);
+    black[3] = Board::flipVertical(black[2]);
+    for (int i = 0; i < 4; i++) {
+        white[i + 4] = Board::transpose(white[i]);
+        black[i + 4] = Board::transpose(black[i]);
+    }
+
+    int n = 0;
+
+    // rows 1 and 8, columns a and h
+    for (int board : {0, 1, 4, 6})
+        out[n++] = OFFSET[EDGE] + ternary(gatherEdge(white[board]), gatherEdge(black[board]));
+
+    // the 4 corners, the copies are already symmetric about the diagonal
+    for (int board = 0; board < 4; board++)
+        out[n++] = OFFSET[CORNER_3X3] + ternary(gatherCorner3x3(white[board]), gatherCorner3x3(black[board]));
+
+    // each corner along both of its edges
+    for (int board = 0; board < 8; board++)
+        out[n++] = OFFSET[CORNER_2X5] + ternary(gatherCorner2x5(white[board]), gatherCorner2x5(black[board]));
+
+    // a1-h8 and h1-a8
+    for (int board : {0, 2})
+        out[n++] = OFFSET[DIAGONAL] + ternary(gatherDiagonal(white[board]), gatherDiagonal(black[board]));
+}
+
+inline void indices(const Board::Position& pos, int out[INSTANCES]) { indices(pos.white, pos.black, out); }
+
+#if BOARD_AVX2
+
+/*
+    The same patterns for 4 positions at once, one per 64-bit lane.
+    Symmetries and gathers are the scalar bit tricks lane by lane
+    (the diagonal folds with shifts, there is no 64-bit multiply),
+    the table lookups are hardware gathers.
+*/
+namespace Avx2 {
+
+constexpr std::array<int32_t, 1024> makeTernary32() {
+    std::array<int32_t, 1024> table = {};
+    for (int bits = 0; bits < 1024; bits++) table[bits] = TERNARY[bits];
+    return table;
+}
+inline constexpr std::array<int32_t, 1024> TERNARY32 = makeTernary32();
+
+BOARD_AVX2_TARGET inline __m256i bits(uint64_t b) { return _mm256_set1_epi64x(static_cast<long long>(b)); }
+
+BOARD_AVX2_TARGET inline __m256i flipVertical(__m256i b) {
+    const __m256i reverse = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                             7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    return _mm256_shuffle_epi8(b, reverse);
+}
+
+BOARD_AVX2_TARGET inline __m256i mirrorHorizontal(__m256i b) {
+    const __m256i m1 = bits(0x5555555555555555ULL), m2 = bits(0x3333333333333333ULL), m4 = bits(0x0f0f0f0f0f0f0f0fULL);
+    b = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi64(b, 1), m1), _mm256_slli_epi64(_mm256_and_si256(b, m1), 1));
+    b = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi64(b, 2), m2), _mm256_slli_epi64(_mm256_and_si256(b, m2), 2));
+    return _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi64(b, 4), m4), _mm256_slli_epi64(_mm256_and_si256(b, m4), 4));
+}
+
+BOARD_AVX2_TARGET inline __m256i transpose(__m256i b) {
+    __m256i t;
+    t = _mm256_and_si256(bits(0x0f0f0f0f00000000ULL), _mm256_xor_si256(b, _mm256_slli_epi64(b, 28)));
+    b = _mm256_xor_si256(b, _mm256_xor_si256(t, _mm256_srli_epi64(t, 28)));
+    t = _mm256_and_si256(bits(0x3333000033330000ULL), _mm256_xor_si256(b, _mm256_slli_epi64(b, 14)));
+    b = _mm256_xor_si256(b, _mm256_xor_si256(t, _mm256_srli_epi64(t, 14)));
+    t = _mm256_and_si256(bits(0x5500550055005500ULL), _mm256_xor_si256(b, _mm256_slli_epi64(b, 7)));
+    return _mm256_xor_si256(b, _mm256_xor_si256(t, _mm256_srli_epi64(t, 7)));
+}
+
+BOARD_AVX2_TARGET inline __m256i gatherEdge(__m256i b) { return _mm256_and_si256(b, bits(0xff)); }
+
+BOARD_AVX2_TARGET inline __m256i gatherCorner3x3(__m256i b) {
+    return _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(b, bits(0x7)),
+                                           _mm256_and_si256(_mm256_srli_epi64(b, 5), bits(0x38))),
+                           _mm256_and_si256(_mm256_srli_epi64(b, 10), bits(0x1c0)));
+}
+
+BOARD_AVX2_TARGET inline __m256i gatherCorner2x5(__m256i b) {
+    return _mm256_or_si256(_mm256_and_si256(b, bits(0x1f)), _mm256_and_si256(_mm256_srli_epi64(b, 3), bits(0x3e0)));
+}
+
+BOARD_AVX2_TARGET inline __m256i gatherDiagonal(__m256i b) {
+    // square 9i ends up in bit i, like the scalar multiply
+    b = _mm256_and_si256(b, bits(0x8040201008040201ULL));
+    b = _mm256_or_si256(b, _mm256_srli_epi64(b, 32));
+    b = _mm256_or_si256(b, _mm256_srli_epi64(b, 16));
+    b = _mm256_or_si256(b, _mm256_srli_epi64(b, 8));
+    return _mm256_and_si256(b, bits(0xff));
+}
+
+BOARD_AVX2_TARGET inline __m128i ternary(__m256i white, __m256i black) {
+    __m128i w = _mm256_i64gather_epi32(TERNARY32.data(), white, 4);
+    __m128i b = _mm256_i64gather_epi32(TERNARY32.data(), black, 4);
+    return _mm_add_epi32(w, _mm_slli_epi32(b, 1));
+}
+
+/*
+    Weight of one pattern copy in each lane. The gather reads 32
+    bits ending at the weight, so the int16 before the table has
+    to be readable too.
+*/
+BOARD_AVX2_TARGET inline __m128i weight(const int16_t* table, __m128i phaseBase, int offset, __m128i index) {
+    __m128i at = _mm_add_epi32(_mm_add_epi32(phaseBase, _mm_set1_epi32(offset)), index);
+    return _mm_srai_epi32(_mm_i32gather_epi32(reinterpret_cast<const int*>(table - 1), at, 2), 16);
+}
+
+// sum of every pattern's weight, in 1/WEIGHT_SCALE discs
+BOARD_AVX2_TARGET inline __m128i sum(const int16_t* table, __m256i whitePieces, __m256i blackPieces, __m128i phaseBase) {
+    __m256i white[8], black[8];
+    white[0] = whitePieces;
+    black[0] = blackPieces;
+    white[1] = flipVertical(white[0]);
+    black[1] = flipVertical(black[0]);
+    white[2] = mirrorHorizontal(white[0]);
+    black[2] = mirrorHorizontal(black[0]);
+    white[3] = flipVertical(white[2]);
+    black[3] = flipVertical(black[2]);
+    for (int i = 0; i < 4; i++) {
+        white[i + 4] = transpose(white[i]);
+        black[i + 4] = transpose(black[i]);
+    }
+
+    __m128i total = _mm_setzero_si128();
+    for (int board : {0, 1, 4, 6})
+        total = _mm_add_epi32(total, weight(table, phaseBase, OFFSET[EDGE], ternary(gatherEdge(white[board]), gatherEdge(black[board]))));
+    for (int board = 0; board < 4; board++)
+        total = _mm_add_epi32(total, weight(table, phaseBase, OFFSET[CORNER_3X3], ternary(gatherCorner3x3(white[board]), gatherCorner3x3(black[board]))));
+    for (int board = 0; board < 8; board++)
+        total = _mm_add_epi32(total, weight(table, phaseBase, OFFSET[CORNER_2X5], ternary(gatherCorner2x5(white[board]), gatherCorner2x5(black[board]))));
+    for (int board : {0, 2})
+        total = _mm_add_epi32(total, weight(table, phaseBase, OFFSET[DIAGONAL], ternary(gatherDiagonal(white[board]), gatherDiagonal(black[board]))));
+    return total;
+}
+
+}
+
+#endif
+
+}
+
+/*
+    Weight file layout: this header, then PHASES * PHASE_SIZE int16
+    weights in host (little-endian) byte order
+*/
+struct WeightFileHeader {
+    char magic[4] = {'O', 'T', 'W', 'T'};
+    uint32_t version = 1;
+    uint32_t phases = Pattern::PHASES;
+    uint32_t phaseSize = Pattern::PHASE_SIZE;
+    uint32_t scale = 0;
+    uint32_t reserved = 0;
+};
+
+class PatternEvaluator : public Evaluator {
+public:
+    // weights are stored in 1/WEIGHT_SCALE discs
+    static constexpr int WEIGHT_SCALE = 64;
+    static constexpr size_t WEIGHT_COUNT = static_cast<size_t>(Pattern::PHASES) * Pattern::PHASE_SIZE;
+    static constexpr const char* DEFAULT_WEIGHTS_FILE = "weights.bin";
+
+    // one spare weight in front, the AVX2 gathers read it
+    PatternEvaluator() : m_weights(WEIGHT_COUNT + 1) {
+        m_table = m_weights.data() + 1;
+        setDefaultWeights();
+    }
+
+    int evaluate(const Board::Position& pos) const override { return score(pos.black, pos.white); }
+    const char* name() const override { return "pattern"; }
+
+    /*
+        With AVX2 on (Board::setAvx2), 4 positions at a time, the
+        rest one by one. The scores match evaluate exactly.
+    */
+    void evaluateBatch(const PositionBatch& batch, int* scores) const override {
+        int i = 0;
+#if BOARD_AVX2
+        if (Board::useAvx2) i = evaluateAvx2(batch, scores);
+#endif
+        for (; i < batch.count; i++) scores[i] = score(batch.black[i], batch.white[i]);
+    }
+
+    /*
+        All WEIGHT_COUNT weights, phase by phase, each phase laid
+        out by Pattern::OFFSET
+    */
+    const int16_t* weights() const { return m_table; }
+
+    /*
+        Map a weight file and use its weights. On failure the
+        current weights are kept and false is returned.
+    */
+    bool load(const std::string& path) {
+        // checked on the side, m_table may point into the current mapping
+        MappedFile file;
+        if (!file.open(path)) return false;
+        
+        WeightFileHeader expected;
+        expected.scale = WEIGHT_SCALE;
+        WeightFileHeader header;
+        if (file.size() != sizeof(header) + WEIGHT_COUNT * sizeof(int16_t)) return false;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, expected.magic, 4) || header.version != expected.version
+            || header.phases != expected.phases || header.phaseSize != expected.phaseSize
+            || header.scale != expected.scale)
+            return false;
+        
+        // the header keeps the weights 2-byte aligned in the mapping, and
+        // gives the AVX2 gathers their spare weight in front
+        m_file = std::move(file);
+        m_table = reinterpret_cast<const int16_t*>(m_file.data() + sizeof(header));
+        m_weights.clear();
+        m_weights.shrink_to_fit();
+        return true;
+    }
+
+    static bool save(const std::string& path, const int16_t* weights) {
+        WeightFileHeader header;
+        header.scale = WEIGHT_SCALE;
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(weights), WEIGHT_COUNT * sizeof(int16_t));
+        return static_cast<bool>(out);
+    }
+
+    /*
+        Shared instance, built once. Uses weights.bin from the
+        working directory when there is a valid one.
+    */
+    static std::shared_ptr<const PatternEvaluator> defaultInstance() {
+        static std::shared_ptr<const PatternEvaluator> instance = [] {
+            auto evaluator = std::make_shared<PatternEvaluator>();
+            evaluator->load(DEFAULT_WEIGHTS_FILE);
+            return evaluator;
+        }();
+        return instance;
+    }
+
+private:
+    std::vector<int16_t> m_weights;     // default weights, emptied once a file is mapped
+    MappedFile m_file;
+    const int16_t* m_table = nullptr;
+
+    int score(Board::Bitboard black, Board::Bitboard white) const {
+        int index[Pattern::INSTANCES];
+        Pattern::indices(white, black, index);
+
+        const int16_t* table = m_table + Pattern::phase(black, white) * Pattern::PHASE_SIZE;
+        int sum = 0;
+        for (int i = 0; i < Pattern::INSTANCES; i++)
+            sum += table[index[i]];
+        return round(sum);
+    }
+
+    // to the nearest disc
+    static int round(int sum) {
+        return (sum >= 0 ? sum + WEIGHT_SCALE / 2 : sum - WEIGHT_SCALE / 2) / WEIGHT_SCALE;
+    }
+
+#if BOARD_AVX2
+    // scores the batch in groups of 4, returns how many it did
+    BOARD_AVX2_TARGET int evaluateAvx2(const PositionBatch& batch, int* scores) const {
+        int i = 0;
+        for (; i + 4 <= batch.count; i += 4) {
+            alignas(16) int phaseBase[4], sums[4];
+            for (int lane = 0; lane < 4; lane++)
+                phaseBase[lane] = Pattern::phase(batch.black[i + lane], batch.white[i + lane]) * Pattern::PHASE_SIZE;
+
+            __m256i white = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.white + i));
+            __m256i black = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.black + i));
+            __m128i sum = Pattern::Avx2::sum(m_table, white, black, _mm_load_si128(reinterpret_cast<const __m128i*>(phaseBase)));
+            _mm_store_si128(reinterpret_cast<__m128i*>(sums), sum);
+            for (int lane = 0; lane < 4; lane++) scores[i + lane] = round(sums[lane]);
+        }
+        return i;
+    }
+#endif
+
+    void setDefaultWeights() {
+        /*
+            Each square adds its static value while the board is
+            open and a plain disc near the end, shared out between
+            the patterns that cover it. A pattern's weight is the
+            sum over its squares, white positive.
+        */
+        int coverage[64];
+        for (int square = 0; square < 64; square++) {
+            Board::Position single;
+            single.black = 0;
+            single.white = Board::squareBit(square);
+            int index[Pattern::INSTANCES];
+            Pattern::indices(single, index);
+
+            coverage[square] = 0;
+            for (int i = 0; i < Pattern::INSTANCES; i++)
+                for (int type = 0; type < Pattern::TYPE_COUNT; type++)
+                    if (index[i] > Pattern::OFFSET[type] && index[i] < Pattern::OFFSET[type + 1])
+                        coverage[square]++;
+        }
+
+        for (int phase = 0; phase < Pattern::PHASES; phase++) {
+            double late = static_cast<double>(phase) / (Pattern::PHASES - 1);
+            int16_t* table = &m_weights[1 + phase * Pattern::PHASE_SIZE];
+
+            for (int type = 0; type < Pattern::TYPE_COUNT; type++) {
+                for (int index = 0; index < Pattern::pow3(Pattern::SIZE[type]); index++) {
+                    double value = 0;
+                    int rest = index;
+                    for (int digit = 0; digit < Pattern::SIZE[type]; digit++, rest /= 3) {
+                        if (rest % 3 == 0) continue;
+                        int square = patternSquare(type, digit);
+                        double discValue = (1 - late) * SQUARE_WEIGHTS[square] / 10.0 + late;
+                        value += (rest % 3 == 1 ? discValue : -discValue) / coverage[square];
+                    }
+                    table[Pattern::OFFSET[type] + index] = static_cast<int16_t>(value * WEIGHT_SCALE);
+                }
+            }
+        }
+    }
+
+    static int patternSquare(int type, int digit) {
+        // square of each digit as read from the a1 corner
+        switch (type) {
+            case Pattern::EDGE: return digit;
+            case Pattern::CORNER_3X3: return Board::squareIndex(digit / 3, digit % 3);
+            case Pattern::CORNER_2X5: return Board::squareIndex(digit / 5, digit % 5);
+            default: return Board::squareIndex(digit, digit);
+        }
+    }
+};
@@ -0,0 +1,126 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Multi-ProbCut parameters. The score of a depth d search is
+          predicted from a search to shallowDepth(d) as
+          a * shallow + b, with error sigma, for every depth and game
+          phase (the pattern evaluator's phases). With selective
+          search on, OthelloBot cuts a node once the shallow score is
+          far enough outside the window that the deep one is likely
+          to be too (see OthelloBot::setProbCut).
+
+          tools/probcut.cpp fits the parameters from game logs.
+          probcut.bin in the working directory is picked up by
+          defaultInstance(), depths and phases it has no fit for
+          keep the defaults.
+*/
+
+#pragma once
+
+#include "PatternEvaluator.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+
+/*
+    Parameter file layout: this header, then phases * depths Params
+    (3 floats each), phase by phase, in host byte order. A sigma of
+    0 marks a depth with no fit.
+*/
+struct ProbCutFileHeader {
+    char magic[4] = {'O', 'T', 'P', 'C'};
+    uint32_t version = 1;
+    uint32_t phases = 0;
+    uint32_t depths = 0;
+};
+
+class ProbCut {
+public:
+    // shallowest depth that is cut, and deepest with its own parameters
+    static constexpr int MIN_DEPTH = 3;
+    static constexpr int MAX_DEPTH = 24;
+    static constexpr int DEPTHS = MAX_DEPTH + 1;
+    static constexpr const char* DEFAULT_PARAMS_FILE = "probcut.bin";
+
+    struct Params {
+        float a = 1;
+        float b = 0;
+        float sigma = 0;    // discs
+    };
+
+    ProbCut() {
+        for (int phase = 0; phase < Pattern::PHASES; phase++)
+            for (int depth = 0; depth < DEPTHS; depth++)
+                m_params[phase][depth] = defaultParams(depth);
+    }
+
+    // depth of the search that predicts a depth d one
+    static int shallowDepth(int depth) { return std::max(1, depth / 2); }
+
+    // deeper searches use the parameters of MAX_DEPTH
+    const Params& params(int phase, int depth) const {
+        return m_params[std::clamp(phase, 0, Pattern::PHASES - 1)][std::clamp(depth, 0, MAX_DEPTH)];
+    }
+    void setParams(int phase, int depth, const Params& params) { m_params[phase][depth] = params; }
+
+    /*
+        Read a parameter file. Entries with no fit keep their
+        current values. On failure nothing changes and false is
+        returned.
+    */
+    bool load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        ProbCutFileHeader header, expected;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+        if (std::memcmp(header.magic, expected.magic, 4) || header.version != expected.version
+            || header.phases != Pattern::PHASES || header.depths != DEPTHS)
+            return false;
+
+        Params params[Pattern::PHASES][DEPTHS];
+        if (!in.read(reinterpret_cast<char*>(params), sizeof(params))) return false;
+        for (int phase = 0; phase < Pattern::PHASES; phase++)
+            for (int depth = 0; depth < DEPTHS; depth++)
+                if (params[phase][depth].sigma > 0 && params[phase][depth].a > 0)
+                    m_params[phase][depth] = params[phase][depth];
+        return true;
+    }
+
+    bool save(const std::string& path) const {
+        ProbCutFileHeader header;
+        header.phases = Pattern::PHASES;
+        header.depths = DEPTHS;
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(m_params), sizeof(m_params));
+        return static_cast<bool>(out);
+    }
+
+    /*
+        Shared parameters, loaded once. Uses probcut.bin from the
+        working directory when there is a valid one.
+    */
+    static std::shared_ptr<const ProbCut> defaultInstance() {
+        static std::shared_ptr<const ProbCut> instance = [] {
+            auto probCut = std::make_shared<ProbCut>();
+            probCut->load(DEFAULT_PARAMS_FILE);
+            return probCut;
+        }();
+        return instance;
+    }
+
+private:
+    Params m_params[Pattern::PHASES][DEPTHS];
+
+    static Params defaultParams(int depth) {
+        /*
+            Roughly the midgame phases of a fit on the default
+            weights, the error grows with the gap between the depths
+        */
+        Params params;
+        params.sigma = 2.0f + 0.5f * (depth - shallowDepth(depth));
+        return params;
+    }
+};
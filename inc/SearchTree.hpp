@@ -4,105 +4,159 @@
     Desc: Search tree data structure for use in TreeDisplay.
           Simplifies traversal and includes useful data like
           size and depth.
+
+          Nodes live in one vector in the order the search visits
+          them (preorder), so a node's subtree is the index range
+          after it, up to its end. Children are found by skipping
+          from one child's end to the next. A node knows its parent
+          instead of its move sequence, which is rebuilt on demand.
+          Clearing keeps the memory for the next tree.
 */
 
 #pragma once
 
-#include <memory>
-#include <vector>
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <string>
+#include <vector>
+
+#include "Board.hpp"
 
 struct SearchNode {
-    int row = -1, col = -1;
-    int heuristic = 0;
-    int depth = 0;
-    bool maximizing = false;
+    uint32_t parent = UINT32_MAX;
+    uint32_t end = 0;                   // one past the last node of the subtree
+    int16_t heuristic = 0;
+    int8_t square = -1;                 // -1 for the root and passes
+    int8_t depth = 0;
+    uint8_t whiteScore = 0;
+    uint8_t blackScore = 0;
     char turn = ' ';
-    int whiteScore = 0;
-    int blackScore = 0;
-    std::string moveSequence = "";
-    std::vector<std::shared_ptr<SearchNode>> children;
+    bool maximizing = false;
+
+    int row() const { return square < 0 ? -1 : square / 8; }
+    int col() const { return square < 0 ? -1 : square % 8; }
 };
 
 class SearchTree {
 public:
-    SearchTree() : m_root(nullptr), m_nodeCount(0) {}
-    SearchTree(std::shared_ptr<SearchNode> root) : m_root(root), m_nodeCount(0) {}
-    
-    std::shared_ptr<SearchNode> getRoot() const { return m_root; }
-    
-    void setRoot(std::shared_ptr<SearchNode> root) { 
-        m_root = root;
-    }
-    
+    using Index = uint32_t;
+    static constexpr Index NONE = UINT32_MAX;
+    static constexpr Index ROOT = 0;
+
+    // children of a node, in the order they were searched
+    class Children {
+    public:
+        class Iterator {
+        public:
+            Iterator(const SearchNode* nodes, Index index) : m_nodes(nodes), m_index(index) {}
+            Index operator*() const { return m_index; }
+            Iterator& operator++() { m_index = m_nodes[m_index].end; return *this; }
+            bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+        private:
+            const SearchNode* m_nodes;
+            Index m_index;
+        };
+
+        Children(const SearchNode* nodes, Index node) : m_nodes(nodes), m_node(node) {}
+        Iterator begin() const { return {m_nodes, m_node + 1}; }
+        Iterator end() const { return {m_nodes, m_nodes[m_node].end}; }
+        bool empty() const { return m_nodes[m_node].end == m_node + 1; }
+    private:
+        const SearchNode* m_nodes;
+        Index m_node;
+    };
+
+    SearchTree() : m_nodeCount(0) {}
+
+    bool hasRoot() const { return !m_nodes.empty(); }
+    const SearchNode& getRoot() const { return m_nodes[ROOT]; }
+    const SearchNode& node(Index index) const { return m_nodes[index]; }
+    SearchNode& node(Index index) { return m_nodes[index]; }
+    Children children(Index index) const { return {m_nodes.data(), index}; }
+
+    // recorded nodes, and the memory they take
+    size_t getNodes() const { return m_nodes.size(); }
+    size_t getMemory() const { return m_nodes.capacity() * sizeof(SearchNode); }
+
     void setSize(size_t size) {
         m_nodeCount = size;
     }
-    
+
     size_t getSize() const {
         return m_nodeCount;
     }
-    
-    void traverse(std::function<void(std::shared_ptr<SearchNode>)> visitor) const {
-        if (!m_root) return;
-        traverseHelper(m_root, visitor);
-    }
-    
-    std::vector<std::shared_ptr<SearchNode>> getPath(int targetRow, int targetCol) const {
-        std::vector<std::shared_ptr<SearchNode>> path;
-        if (!m_root) return path;
-        findPath(m_root, targetRow, targetCol, path);
-        return path;
+
+    /*
+        Recording. add() appends a node under parent (NONE for the
+        root), the parent must be the last node added or one of its
+        ancestors. finish() works out the subtree ends once the
+        tree is complete.
+    */
+    void clear() { m_nodes.clear(); }
+
+    Index add(Index parent, const SearchNode& node) {
+        Index index = static_cast<Index>(m_nodes.size());
+        m_nodes.push_back(node);
+        m_nodes.back().parent = parent;
+        return index;
     }
-    
-    int getMaxDepth() const {
-        if (!m_root) return 0;
-        return calculateMaxDepth(m_root, 0);
+
+    // drop the subtree below node, which must have been added last or be its root
+    void clearChildren(Index node) { m_nodes.resize(node + 1); }
+
+    void finish() {
+        for (Index i = 0; i < m_nodes.size(); i++) m_nodes[i].end = i + 1;
+        for (Index i = static_cast<Index>(m_nodes.size()); i-- > 1;) {
+            SearchNode& parent = m_nodes[m_nodes[i].parent];
+            parent.end = std::max(parent.end, m_nodes[i].end);
+        }
     }
 
-private:
-    std::shared_ptr<SearchNode> m_root;
-    size_t m_nodeCount;
-    
-    size_t countNodes(std::shared_ptr<SearchNode> node) const {
-        if (!node) return 0;
-        size_t count = 1;
-        for (auto& child : node->children)
-            count += countNodes(child);
-        return count;
+    // moves from the root, "d3 -> c5 -> ..."
+    std::string moveSequence(Index index) const {
+        if (index == ROOT) return "Root";
+        std::vector<Index> path;
+        for (Index i = index; i != ROOT; i = m_nodes[i].parent) path.push_back(i);
+
+        std::string sequence;
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            const SearchNode& node = m_nodes[*it];
+            if (!sequence.empty()) sequence += " -> ";
+            sequence += node.square < 0 ? "pass" : Board::moveKey(node.row(), node.col());
+        }
+        return sequence;
     }
-    
-    void traverseHelper(std::shared_ptr<SearchNode> node, std::function<void(std::shared_ptr<SearchNode>)> visitor) const {
-        if (!node) return;
-        visitor(node);
-        for (auto& child : node->children)
-            traverseHelper(child, visitor);
+
+    void traverse(std::function<void(Index)> visitor) const {
+        for (Index i = 0; i < m_nodes.size(); i++)
+            visitor(i);
     }
-    
-    bool findPath(std::shared_ptr<SearchNode> node, int targetRow, int targetCol, std::vector<std::shared_ptr<SearchNode>>& path) const {
-        if (!node) return false;
-        
-        path.push_back(node);
-        
-        if (node->row == targetRow && node->col == targetCol)
-            return true;
-        
-        for (auto& child : node->children)
-            if (findPath(child, targetRow, targetCol, path))
-                return true;
-        
-        path.pop_back();
-        return false;
+
+    // root to the first node that plays (targetRow, targetCol)
+    std::vector<Index> getPath(int targetRow, int targetCol) const {
+        std::vector<Index> path;
+        for (Index i = 0; i < m_nodes.size(); i++) {
+            if (m_nodes[i].row() != targetRow || m_nodes[i].col() != targetCol) continue;
+            for (Index node = i; node != NONE; node = m_nodes[node].parent) path.push_back(node);
+            std::reverse(path.begin(), path.end());
+            break;
+        }
+        return path;
     }
-    
-    int calculateMaxDepth(std::shared_ptr<SearchNode> node, int currentDepth) const {
-        if (!node) return currentDepth - 1;
-        
-        int maxChildDepth = currentDepth;
-        for (auto& child : node->children) {
-            int childDepth = calculateMaxDepth(child, currentDepth + 1);
-            maxChildDepth = std::max(maxChildDepth, childDepth);
+
+    int getMaxDepth() const {
+        // parents come first, so one pass finds every level
+        std::vector<int> level(m_nodes.size(), 0);
+        int maxLevel = 0;
+        for (Index i = 1; i < m_nodes.size(); i++) {
+            level[i] = level[m_nodes[i].parent] + 1;
+            maxLevel = std::max(maxLevel, level[i]);
         }
-        return maxChildDepth;
+        return maxLevel;
     }
-};
\ No newline at end of file
+
+private:
+    std::vector<SearchNode> m_nodes;
+    size_t m_nodeCount;
+};
@@ -0,0 +1,184 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Fixed-size transposition table keyed by Zobrist hash.
+          Entries are grouped in buckets of 4 (one cache line).
+          Replacement prefers keeping deep entries from the current
+          search, entries left over from older searches go first.
+          The table is shared by all search threads without locks:
+          each slot stores key ^ data next to data, so a slot torn by
+          two threads writing at once fails the key check on probe.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+enum class Bound : uint8_t { NONE, EXACT, LOWER, UPPER };
+
+struct TTEntry {
+    uint64_t key = 0;
+    int16_t score = 0;
+    int8_t bestMove = -1;
+    int8_t depth = 0;
+    Bound bound = Bound::NONE;
+    uint8_t age = 0;
+};
+
+class TranspositionTable {
+public:
+    static constexpr int BUCKET_SIZE = 4;
+
+    TranspositionTable(size_t megabytes = 16) { resize(megabytes); }
+
+    void resize(size_t megabytes) {
+        /*
+            Round the bucket count down to a power of 2 so the
+            index is a mask of the key
+        */
+        size_t buckets = (megabytes * 1024 * 1024) / sizeof(Bucket);
+        size_t count = 1;
+        while (count * 2 <= buckets) count *= 2;
+        m_buckets = std::make_unique<Bucket[]>(count);
+        m_count = count;
+        m_mask = count - 1;
+        m_megabytes = megabytes;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < m_count; i++)
+            for (Slot& slot : m_buckets[i].slots)
+                slot.write(0, 0);
+        m_age = 0;
+    }
+
+    size_t sizeMB() const { return m_megabytes; }
+
+    /*
+        Called once per search. Entries from earlier searches stay
+        usable but become the first to be replaced.
+    */
+    void newSearch() { m_age++; }
+
+    bool probe(uint64_t key, TTEntry& out) {
+        Bucket& bucket = m_buckets[key & m_mask];
+        for (Slot& slot : bucket.slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if ((slot.check.load(std::memory_order_relaxed) ^ data) != key) continue;
+
+            out = unpack(key, data);
+            if (out.bound == Bound::NONE) continue;
+
+            // found again this search, it is not stale
+            if (out.age != m_age) {
+                out.age = m_age;
+                slot.write(key, pack(out));
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void store(uint64_t key, int depth, Bound bound, int score, int bestMove) {
+        Bucket& bucket = m_buckets[key & m_mask];
+        Slot* replace = &bucket.slots[0];
+        int replaceValue = INT_MAX;
+
+        for (Slot& slot : bucket.slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            TTEntry entry = unpack(slot.check.load(std::memory_order_relaxed) ^ data, data);
+
+            // same position, only overwrite with an equal or deeper result
+            if (entry.key == key && entry.bound != Bound::NONE) {
+                if (depth < entry.depth && bound != Bound::EXACT) return;
+                if (bestMove < 0) bestMove = entry.bestMove;
+                replace = &slot;
+                break;
+            }
+
+            int value = replacementValue(entry);
+            if (value < replaceValue) {
+                replaceValue = value;
+                replace = &slot;
+            }
+        }
+
+        TTEntry entry;
+        entry.key = key;
+        entry.score = static_cast<int16_t>(score);
+        entry.bestMove = static_cast<int8_t>(bestMove);
+        entry.depth = static_cast<int8_t>(depth);
+        entry.bound = bound;
+        entry.age = m_age;
+        replace->write(key, pack(entry));
+    }
+
+    /*
+        Fraction of a sample of entries written during this search
+    */
+    double fill() const {
+        size_t sampled = 0, used = 0;
+        for (size_t i = 0; i < m_count && sampled < 1000; i++) {
+            for (const Slot& slot : m_buckets[i].slots) {
+                sampled++;
+                TTEntry entry = unpack(0, slot.data.load(std::memory_order_relaxed));
+                if (entry.bound != Bound::NONE && entry.age == m_age) used++;
+            }
+        }
+        return sampled ? static_cast<double>(used) / sampled : 0.0;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check{0};     // key ^ data
+        std::atomic<uint64_t> data{0};
+
+        void write(uint64_t key, uint64_t value) {
+            check.store(key ^ value, std::memory_order_relaxed);
+            data.store(value, std::memory_order_relaxed);
+        }
+    };
+
+    struct alignas(64) Bucket {
+        Slot slots[BUCKET_SIZE];
+    };
+
+    std::unique_ptr<Bucket[]> m_buckets;
+    size_t m_count = 0;
+    size_t m_mask = 0;
+    size_t m_megabytes = 0;
+    uint8_t m_age = 0;
+
+    static uint64_t pack(const TTEntry& entry) {
+        return static_cast<uint64_t>(static_cast<uint16_t>(entry.score))
+             | static_cast<uint64_t>(static_cast<uint8_t>(entry.bestMove)) << 16
+             | static_cast<uint64_t>(static_cast<uint8_t>(entry.depth)) << 24
+             | static_cast<uint64_t>(entry.bound) << 32
+             | static_cast<uint64_t>(entry.age) << 40;
+    }
+
+    static TTEntry unpack(uint64_t key, uint64_t data) {
+        TTEntry entry;
+        entry.key = key;
+        entry.score = static_cast<int16_t>(data & 0xffff);
+        entry.bestMove = static_cast<int8_t>((data >> 16) & 0xff);
+        entry.depth = static_cast<int8_t>((data >> 24) & 0xff);
+        entry.bound = static_cast<Bound>((data >> 32) & 0xff);
+        entry.age = static_cast<uint8_t>((data >> 40) & 0xff);
+        return entry;
+    }
+
+    int replacementValue(const TTEntry& entry) const {
+        /*
+            Lower is replaced first: empty slots, then entries from old
+            searches (4 plies per search of age), then shallow ones.
+        */
+        if (entry.bound == Bound::NONE) return -1000;
+        int staleness = static_cast<uint8_t>(m_age - entry.age);
+        return entry.depth - 4 * staleness;
+    }
+};
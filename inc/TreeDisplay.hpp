@@ -52,20 +52,20 @@ private:
     
     bool m_positionsCalculated = false;
     
-    std::shared_ptr<SearchNode> m_selectedNode = nullptr;
+    SearchTree::Index m_selectedNode = SearchTree::NONE;
     
-    void drawNode(std::shared_ptr<SearchNode> node, int level, int maxDepth, float nodeWidth, float nodeHeight, float verticalSpacing, sf::Font& font, bool fontLoaded);
-    void collectNodesAtLevel(std::shared_ptr<SearchNode> node, int targetLevel, int currentLevel, std::vector<std::shared_ptr<SearchNode>>& nodes);
+    void drawNode(SearchTree::Index node, int level, int maxDepth, float nodeWidth, float nodeHeight, float verticalSpacing, sf::Font& font, bool fontLoaded);
+    void collectNodesAtLevel(SearchTree::Index node, int targetLevel, int currentLevel, std::vector<SearchTree::Index>& nodes);
     void handleInput();
-    void calculateNodePositions(std::shared_ptr<SearchNode> node, float startX, float nodeWidth, float horizontalSpacing);
-    void storeNodeBounds(std::shared_ptr<SearchNode> node, int level, float nodeWidth, float nodeHeight, float verticalSpacing);
-    float calculateSubtreeWidth(std::shared_ptr<SearchNode> node, float nodeWidth, float horizontalSpacing);
+    void calculateNodePositions(SearchTree::Index node, float startX, float nodeWidth, float horizontalSpacing);
+    void storeNodeBounds(SearchTree::Index node, int level, float nodeWidth, float nodeHeight, float verticalSpacing);
+    float calculateSubtreeWidth(SearchTree::Index node, float nodeWidth, float horizontalSpacing);
     void updateDeltaTime();
     bool isNodeInView(float x, float y, float nodeWidth, float nodeHeight);
     void centerViewOnRoot();
     
-    std::map<std::shared_ptr<SearchNode>, float> m_nodePositions;
-    std::map<std::shared_ptr<SearchNode>, sf::FloatRect> m_nodeBounds;
+    std::map<SearchTree::Index, float> m_nodePositions;
+    std::map<SearchTree::Index, sf::FloatRect> m_nodeBounds;
 };
 
 TreeDisplay::TreeDisplay(SearchTree& tree)
@@ -84,7 +84,7 @@ void TreeDisplay::createWindow() {
 
     m_window.create(
         m_screenRes,
-        std::string{m_tree.getRoot()->turn == 'b' ? "Black Tree" : "WhiteTree"},
+        std::string{!m_tree.hasRoot() ? "Search Tree" : m_tree.getRoot().turn == 'b' ? "Black Tree" : "WhiteTree"},
         sf::Style::Titlebar | sf::Style::Close,
         sf::State::Windowed
     );
@@ -112,7 +112,7 @@ void TreeDisplay::render() {
 }
 
 void TreeDisplay::drawTree() {
-    if (!m_tree.getRoot()) return;
+    if (!m_tree.hasRoot()) return;
     
     sf::Font font;
     bool fontLoaded = font.openFromMemory(uilo::EMBEDDED_DEJAVUSANS_FONT.data(), uilo::EMBEDDED_DEJAVUSANS_FONT.size());
@@ -127,20 +127,20 @@ void TreeDisplay::drawTree() {
         m_nodePositions.clear();
         m_nodeBounds.clear();
         float horizontalSpacing = 20.0f;
-        calculateNodePositions(m_tree.getRoot(), 0.0f, nodeWidth, horizontalSpacing);
-        storeNodeBounds(m_tree.getRoot(), 0, nodeWidth, nodeHeight, verticalSpacing);
+        calculateNodePositions(SearchTree::ROOT, 0.0f, nodeWidth, horizontalSpacing);
+        storeNodeBounds(SearchTree::ROOT, 0, nodeWidth, nodeHeight, verticalSpacing);
         m_positionsCalculated = true;        
         centerViewOnRoot();
     }
     
-    drawNode(m_tree.getRoot(), 0, maxDepth, nodeWidth, nodeHeight, verticalSpacing, font, fontLoaded);
+    drawNode(SearchTree::ROOT, 0, maxDepth, nodeWidth, nodeHeight, verticalSpacing, font, fontLoaded);
     
-    if (m_selectedNode && fontLoaded) {
+    if (m_selectedNode != SearchTree::NONE && fontLoaded) {
         sf::View originalView = m_window.getView();
         m_window.setView(m_window.getDefaultView());
         
         sf::Text sequenceText(font);
-        sequenceText.setString("Sequence: " + m_selectedNode->moveSequence);
+        sequenceText.setString("Sequence: " + m_tree.moveSequence(m_selectedNode));
         sequenceText.setCharacterSize(32);
         sequenceText.setFillColor(sf::Color::White);
         sequenceText.setPosition({10.f, 10.f});
@@ -157,16 +157,14 @@ void TreeDisplay::drawTree() {
     }
 }
 
-void TreeDisplay::drawNode(std::shared_ptr<SearchNode> node, int level, int maxDepth, float nodeWidth, float nodeHeight, float verticalSpacing, sf::Font& font, bool fontLoaded) {
-    if (!node) return;
-    
+void TreeDisplay::drawNode(SearchTree::Index node, int level, int maxDepth, float nodeWidth, float nodeHeight, float verticalSpacing, sf::Font& font, bool fontLoaded) {
     float x = m_nodePositions[node];
     float y = 50.0f + level * (nodeHeight + verticalSpacing);
     
     float nodeCenterX = x + nodeWidth / 2.0f;
     float nodeBottomY = y + nodeHeight;
     
-    for (auto& child : node->children) {
+    for (SearchTree::Index child : m_tree.children(node)) {
         float childX = m_nodePositions[child];
         float childY = 50.0f + (level + 1) * (nodeHeight + verticalSpacing);
         float childCenterX = childX + nodeWidth / 2.0f;
@@ -193,7 +191,7 @@ void TreeDisplay::drawNode(std::shared_ptr<SearchNode> node, int level, int maxD
     }
     
     if (!isNodeInView(x, y, nodeWidth, nodeHeight)) {
-        for (auto& child : node->children)
+        for (SearchTree::Index child : m_tree.children(node))
             drawNode(child, level + 1, maxDepth, nodeWidth, nodeHeight, verticalSpacing, font, fontLoaded);
         return;
     }
@@ -204,7 +202,8 @@ void TreeDisplay::drawNode(std::shared_ptr<SearchNode> node, int level, int maxD
     sf::Color nodeColor;
     
     // Green = maximizing (White), Red = minimizing (Black)
-    if (node->maximizing)
+    const SearchNode& data = m_tree.node(node);
+    if (data.maximizing)
         nodeColor = fromHex("#2d5c2dff");
     else
         nodeColor = fromHex("#7d4040ff");
@@ -220,11 +219,11 @@ void TreeDisplay::drawNode(std::shared_ptr<SearchNode> node, int level, int maxD
     
     if (fontLoaded) {
         sf::Text nodeText(font);
-        std::string text = "Move: (" + std::to_string(node->row) + "," + std::to_string(node->col) + ")\n";
-        text += "Heuristic: " + std::to_string(node->heuristic) + "\n";
-        text += "Depth: " + std::to_string(node->depth) + "\n";
-        text += "Turn: " + std::string(1, node->turn) + "\n";
-        text += "Score: " + std::to_string(node->whiteScore) + "-" + std::to_string(node->blackScore);
+        std::string text = "Move: (" + std::to_string(data.row()) + "," + std::to_string(data.col()) + ")\n";
+        text += "Heuristic: " + std::to_string(data.heuristic) + "\n";
+        text += "Depth: " + std::to_string(data.depth) + "\n";
+        text += "Turn: " + std::string(1, data.turn) + "\n";
+        text += "Score: " + std::to_string(data.whiteScore) + "-" + std::to_string(data.blackScore);
         
         nodeText.setString(text);
         nodeText.setCharacterSize(10);
@@ -234,19 +233,17 @@ void TreeDisplay::drawNode(std::shared_ptr<SearchNode> node, int level, int maxD
         m_window.draw(nodeText);
     }
     
-    for (auto& child : node->children)
+    for (SearchTree::Index child : m_tree.children(node))
         drawNode(child, level + 1, maxDepth, nodeWidth, nodeHeight, verticalSpacing, font, fontLoaded);
 }
 
-void TreeDisplay::collectNodesAtLevel(std::shared_ptr<SearchNode> node, int targetLevel, int currentLevel, std::vector<std::shared_ptr<SearchNode>>& nodes) {
-    if (!node) return;
-    
+void TreeDisplay::collectNodesAtLevel(SearchTree::Index node, int targetLevel, int currentLevel, std::vector<SearchTree::Index>& nodes) {
     if (currentLevel == targetLevel) {
         nodes.push_back(node);
         return;
     }
     
-    for (auto& child : node->children)
+    for (SearchTree::Index child : m_tree.children(node))
         collectNodesAtLevel(child, targetLevel, currentLevel + 1, nodes);
 }
 
@@ -308,30 +305,30 @@ void TreeDisplay::pollEvents() {
     }
 }
 
-float TreeDisplay::calculateSubtreeWidth(std::shared_ptr<SearchNode> node, float nodeWidth, float horizontalSpacing) {
-    if (!node || node->children.empty()) {
+float TreeDisplay::calculateSubtreeWidth(SearchTree::Index node, float nodeWidth, float horizontalSpacing) {
+    if (m_tree.children(node).empty()) {
         return nodeWidth;
     }
     
     float totalChildrenWidth = 0.0f;
-    for (size_t i = 0; i < node->children.size(); ++i) {
-        if (i > 0) totalChildrenWidth += horizontalSpacing;
-        totalChildrenWidth += calculateSubtreeWidth(node->children[i], nodeWidth, horizontalSpacing);
+    bool first = true;
+    for (SearchTree::Index child : m_tree.children(node)) {
+        if (!first) totalChildrenWidth += horizontalSpacing;
+        totalChildrenWidth += calculateSubtreeWidth(child, nodeWidth, horizontalSpacing);
+        first = false;
     }
     
     return std::max(nodeWidth, totalChildrenWidth);
 }
 
-void TreeDisplay::calculateNodePositions(std::shared_ptr<SearchNode> node, float startX, float nodeWidth, float horizontalSpacing) {
-    if (!node) return;
-    
+void TreeDisplay::calculateNodePositions(SearchTree::Index node, float startX, float nodeWidth, float horizontalSpacing) {
     float subtreeWidth = calculateSubtreeWidth(node, nodeWidth, horizontalSpacing);    
     m_nodePositions[node] = startX + (subtreeWidth - nodeWidth) / 2.0f;
     
-    if (!node->children.empty()) {
+    if (!m_tree.children(node).empty()) {
         float childStartX = startX;
         
-        for (auto& child : node->children) {
+        for (SearchTree::Index child : m_tree.children(node)) {
             float childSubtreeWidth = calculateSubtreeWidth(child, nodeWidth, horizontalSpacing);
             calculateNodePositions(child, childStartX, nodeWidth, horizontalSpacing);
             childStartX += childSubtreeWidth + horizontalSpacing;
@@ -364,10 +361,10 @@ bool TreeDisplay::isNodeInView(float x, float y, float nodeWidth, float nodeHeig
 void TreeDisplay::setTree(SearchTree& tree) {
     m_tree = tree;
     m_positionsCalculated = false;
-    m_selectedNode = nullptr;
+    m_selectedNode = SearchTree::NONE;
     
-    if (m_tree.getRoot()) {
-        std::string title = m_tree.getRoot()->turn == 'b' ? "Black Tree" : "White Tree";
+    if (m_tree.hasRoot()) {
+        std::string title = m_tree.getRoot().turn == 'b' ? "Black Tree" : "White Tree";
         m_window.setTitle(title);
     }
     
@@ -375,9 +372,9 @@ void TreeDisplay::setTree(SearchTree& tree) {
 }
 
 void TreeDisplay::centerViewOnRoot() {
-    if (!m_tree.getRoot() || m_nodePositions.empty()) return;
+    if (!m_tree.hasRoot() || m_nodePositions.empty()) return;
     
-    float rootX = m_nodePositions[m_tree.getRoot()];
+    float rootX = m_nodePositions[SearchTree::ROOT];
     const float nodeWidth = 120.0f;
     const float nodeHeight = 80.0f;
     const float rootY = 50.0f;
@@ -394,14 +391,14 @@ void TreeDisplay::centerViewOnRoot() {
     m_window.setView(m_windowView);
 }
 
-void TreeDisplay::storeNodeBounds(std::shared_ptr<SearchNode> node, int level, float nodeWidth, float nodeHeight, float verticalSpacing) {
+void TreeDisplay::storeNodeBounds(SearchTree::Index node, int level, float nodeWidth, float nodeHeight, float verticalSpacing) {
     
     float x = m_nodePositions[node];
     float y = 50.0f + level * (nodeHeight + verticalSpacing);
     
     m_nodeBounds[node] = sf::FloatRect({x, y}, {nodeWidth, nodeHeight});
     
-    for (auto& child : node->children) {
+    for (SearchTree::Index child : m_tree.children(node)) {
         storeNodeBounds(child, level + 1, nodeWidth, nodeHeight, verticalSpacing);
     }
 }
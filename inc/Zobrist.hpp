@@ -0,0 +1,78 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Zobrist keys for hashing positions. A position's key is the
+          XOR of one random key per (color, square) piece, plus a key
+          when white is to move, so it can be updated incrementally.
+*/
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+namespace Zobrist {
+
+constexpr uint64_t splitMix64(uint64_t& seed) {
+    uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+struct Keys {
+    uint64_t piece[2][64] = {};     // [0] = black, [1] = white
+    uint64_t flip[64] = {};         // piece[0][sq] ^ piece[1][sq]
+    uint64_t whiteToMove = 0;
+};
+
+constexpr Keys makeKeys() {
+    /*
+        Fixed seed so keys (and any stored hashes) are the same
+        from run to run
+    */
+    Keys keys;
+    uint64_t seed = 0x4f7468656c6c6fULL;
+    for (int color = 0; color < 2; color++)
+        for (int square = 0; square < 64; square++)
+            keys.piece[color][square] = splitMix64(seed);
+    for (int square = 0; square < 64; square++)
+        keys.flip[square] = keys.piece[0][square] ^ keys.piece[1][square];
+    keys.whiteToMove = splitMix64(seed);
+    return keys;
+}
+
+inline constexpr Keys KEYS = makeKeys();
+
+inline uint64_t hash(uint64_t black, uint64_t white, char turn) {
+    /*
+        Full hash from scratch, used when a position is created
+    */
+    uint64_t key = (turn == 'w') ? KEYS.whiteToMove : 0;
+    while (black) {
+        key ^= KEYS.piece[0][std::countr_zero(black)];
+        black &= black - 1;
+    }
+    while (white) {
+        key ^= KEYS.piece[1][std::countr_zero(white)];
+        white &= white - 1;
+    }
+    return key;
+}
+
+inline uint64_t moveDelta(int color, int square, uint64_t flips) {
+    /*
+        XOR difference between a position and the one after color
+        places on square and flips the given pieces. Applying it
+        a second time takes the move back.
+    */
+    uint64_t key = KEYS.piece[color][square] ^ KEYS.whiteToMove;
+    while (flips) {
+        key ^= KEYS.flip[std::countr_zero(flips)];
+        flips &= flips - 1;
+    }
+    return key;
+}
+
+}
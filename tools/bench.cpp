@@ -0,0 +1,280 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Search benchmark. Runs getBestMove over a fixed set of
+          midgame and endgame positions for every configuration
+          (minimax and alpha-beta, each depth) and prints JSON with
+          nodes, time, nodes/sec, effective branching factor, best
+          move and repeated searches (PVS and aspiration), per run
+          and per configuration. Positions with at most
+          --endgame-empties empties are also solved exactly (search
+          "endgame", depth = empties). Last, the positions two plies
+          past every set position are analyzed to --batch-depth as
+          one BatchAnalyzer batch and with getBestMove in a loop
+          (search "batch", positions/sec for both).
+
+          bench [--minimax-depth N] [--alphabeta-depth N]
+                [--endgame-empties N] [--batch-depth N]
+                [--threads N] [--hash MB] [--weights FILE]
+
+          Leaves are scored with the built-in pattern weights, not
+          weights.bin, so results don't depend on the working
+          directory. --weights FILE uses that file instead, the JSON
+          names the weights used.
+
+          Every run starts from a fresh bot, so hash and history
+          from one run never help the next, except in the batch
+          loop, which is one bot like a caller would keep. Progress
+          goes to stderr.
+*/
+
+#include "Engine.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// seeded random playouts stopped at fixed empty counts, midgame first.
+// Stored as text so movegen changes can't change the set.
+const char* POSITIONS[] = {
+    "---------O--OOO---O-OOX---XOOXO--XOOX----OOX-------------------- X",
+    "O---XO---O--OO----OOXO----XOXO-----XOO-----XXOO---X---O-------O- X",
+    "----X------X-----OX-OO-O-XXXOXXXXXXXOO-----OOO----OOO-----O-O--- X",
+    "-XXXX------O-O----XXOXXXXXXOX---XX-XOOO-X--OOO----OX-O-----X--O- X",
+    "X-O------XO-------X-OX--XXOXOO-OOXOXXXOX-OXXOO--OX-XX---X--XOOO- X",
+    "----OXXX-OOOOOO---OOOOOOX-OOOXX-OXOOO--X-XXOOO---XXX--O-XXX----- X",
+    "-XX-XOO---XOOO---OOOXXX--XOOXOX-XOOOOXXXO-OOX-X--OOXXXXO--O-X-X- X",
+    "-X-O-X---OO-OX--OOOXXOXXOOOOOOOXO-XXXOOXOOXXOOOX-XXOO-OXX--O---- X",
+    "--OOX-----OOO-X---OOOXXXO-OXOOXXXXOXOXO-XXOOOXO-XOOOOOOOOO-O-XXX X",
+    "-O-X-X--XXXXXXXXXOOOO-X-XOXOOXX-XOXXOOXOXOOXOXXO-OX-XXX-O-X-OXX- X",
+    "OOOX--O-OOOOOOO-OXXOOOO-XXXXXOOX-OXXXOOXOXOXXXOXX--XXXOX--OX--OX X",
+};
+
+struct RunResult {
+    size_t nodes = 0;
+    double ms = 0;
+    int bestMove = -1;
+    int score = 0;
+    size_t researches = 0;
+    size_t aspirationResearches = 0;
+};
+
+RunResult runSearch(const Board::Position& pos, bool alphaBeta, int depth, int threads, int hashMB,
+                    const std::shared_ptr<const Evaluator>& evaluator) {
+    OthelloBot bot(depth);
+    if (alphaBeta) bot.toggleAlphaBeta();
+    bot.setThreads(threads);
+    bot.setHashSize(hashMB);
+    bot.setEvaluator(evaluator);
+
+    // depth runs measure the depth-limited search, not the solver or book
+    bot.setEndgameEmpties(0);
+    bot.setOpeningBook(nullptr);
+
+    Board::State state;
+    Board::fromPosition(state, pos);
+
+    auto start = std::chrono::steady_clock::now();
+    auto [row, col] = bot.getBestMove(state);
+    RunResult result;
+    result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.nodes = bot.getTreeSize();
+    result.bestMove = (row < 0) ? -1 : Board::squareIndex(row, col);
+    result.score = bot.getLastScore();
+    result.researches = bot.getResearches();
+    result.aspirationResearches = bot.getAspirationResearches();
+    return result;
+}
+
+// every position two moves on
+std::vector<Board::Position> grandchildren(const std::vector<Board::Position>& positions) {
+    std::vector<Board::Position> out;
+    for (Board::Position pos : positions) {
+        Board::MoveList moves;
+        pos.generateMoves(moves);
+        for (const Board::Move& move : moves) {
+            pos.makeMove(move);
+            Board::MoveList replies;
+            pos.generateMoves(replies);
+            for (const Board::Move& reply : replies) {
+                pos.makeMove(reply);
+                out.push_back(pos);
+                pos.undoMove(reply);
+            }
+            pos.undoMove(move);
+        }
+    }
+    return out;
+}
+
+double nodesPerSecond(size_t nodes, double ms) {
+    return ms > 0 ? nodes * 1000.0 / ms : 0.0;
+}
+
+double branchingFactor(size_t nodes, int depth) {
+    // b such that b^depth = nodes
+    return (nodes > 0 && depth > 0) ? std::pow(static_cast<double>(nodes), 1.0 / depth) : 0.0;
+}
+
+int main(int argc, char** argv) {
+    int minimaxDepth = 6;
+    int alphaBetaDepth = 10;
+    int endgameEmpties = 20;
+    int batchDepth = 4;
+    int threads = 1;
+    int hashMB = 16;
+    std::string weightsPath;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--minimax-depth") && hasValue) minimaxDepth = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--alphabeta-depth") && hasValue) alphaBetaDepth = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--endgame-empties") && hasValue) endgameEmpties = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--batch-depth") && hasValue) batchDepth = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--threads") && hasValue) threads = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--hash") && hasValue) hashMB = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--weights") && hasValue) weightsPath = argv[++i];
+        else {
+            std::cerr << "usage: " << argv[0] << " [--minimax-depth N] [--alphabeta-depth N] [--endgame-empties N] [--batch-depth N] [--threads N] [--hash MB] [--weights FILE]\n";
+            return 1;
+        }
+    }
+
+    // built-in weights unless a file is given
+    auto patterns = std::make_shared<PatternEvaluator>();
+    if (!weightsPath.empty() && !patterns->load(weightsPath)) {
+        std::cerr << "can't load weights: " << weightsPath << "\n";
+        return 1;
+    }
+    std::shared_ptr<const Evaluator> evaluator = patterns;
+
+    std::vector<Board::Position> positions;
+    for (const char* text : POSITIONS) {
+        Board::Position pos;
+        if (!Board::parsePosition(text, pos)) {
+            std::cerr << "bad position: " << text << "\n";
+            return 1;
+        }
+        positions.push_back(pos);
+    }
+
+    std::cout << "{\n  \"threads\": " << threads << ",\n  \"hash_mb\": " << hashMB
+              << ",\n  \"weights\": \"" << (weightsPath.empty() ? "built-in" : weightsPath) << "\""
+              << ",\n  \"configs\": [";
+
+    bool firstConfig = true;
+    for (bool alphaBeta : {false, true}) {
+        int maxDepth = alphaBeta ? alphaBetaDepth : minimaxDepth;
+        const char* name = alphaBeta ? "alphabeta" : "minimax";
+
+        for (int depth = 1; depth <= maxDepth; depth++) {
+            std::cerr << name << " depth " << depth << "\n";
+            std::cout << (firstConfig ? "" : ",") << "\n    {\"search\": \"" << name << "\", \"depth\": " << depth << ", \"runs\": [";
+            firstConfig = false;
+
+            size_t totalNodes = 0, totalResearches = 0, totalAspirationResearches = 0;
+            double totalMs = 0;
+            for (size_t i = 0; i < positions.size(); i++) {
+                RunResult run = runSearch(positions[i], alphaBeta, depth, threads, hashMB, evaluator);
+                totalNodes += run.nodes;
+                totalMs += run.ms;
+                totalResearches += run.researches;
+                totalAspirationResearches += run.aspirationResearches;
+
+                std::cout << (i ? "," : "") << "\n      {\"position\": " << i
+                          << ", \"empties\": " << std::popcount(positions[i].empty())
+                          << ", \"nodes\": " << run.nodes
+                          << ", \"time_ms\": " << run.ms
+                          << ", \"nps\": " << static_cast<size_t>(nodesPerSecond(run.nodes, run.ms))
+                          << ", \"ebf\": " << branchingFactor(run.nodes, depth)
+                          << ", \"best_move\": \"" << Board::squareName(run.bestMove) << "\""
+                          << ", \"score\": " << run.score
+                          << ", \"researches\": " << run.researches
+                          << ", \"aspiration_researches\": " << run.aspirationResearches << "}";
+            }
+
+            // ebf of the average tree over the set
+            size_t meanNodes = totalNodes / positions.size();
+            std::cout << "\n    ], \"nodes\": " << totalNodes
+                      << ", \"time_ms\": " << totalMs
+                      << ", \"nps\": " << static_cast<size_t>(nodesPerSecond(totalNodes, totalMs))
+                      << ", \"ebf\": " << branchingFactor(meanNodes, depth)
+                      << ", \"researches\": " << totalResearches
+                      << ", \"aspiration_researches\": " << totalAspirationResearches << "}";
+        }
+    }
+
+    // exact solves, one configuration for the whole set
+    std::cerr << "endgame\n";
+    std::cout << (firstConfig ? "" : ",") << "\n    {\"search\": \"endgame\", \"runs\": [";
+    size_t totalNodes = 0;
+    double totalMs = 0;
+    bool firstRun = true;
+    for (size_t i = 0; i < positions.size(); i++) {
+        int empties = std::popcount(positions[i].empty());
+        if (empties > endgameEmpties) continue;
+
+        EndgameSolver solver(hashMB);
+        auto start = std::chrono::steady_clock::now();
+        EndgameSolver::Result result = solver.solve(positions[i]);
+
+        // scores in the output are white - black, like the bot's
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        totalNodes += result.nodes;
+        totalMs += ms;
+
+        std::cout << (firstRun ? "" : ",") << "\n      {\"position\": " << i
+                  << ", \"empties\": " << empties
+                  << ", \"nodes\": " << result.nodes
+                  << ", \"time_ms\": " << ms
+                  << ", \"nps\": " << static_cast<size_t>(nodesPerSecond(result.nodes, ms))
+                  << ", \"ebf\": " << branchingFactor(result.nodes, empties)
+                  << ", \"best_move\": \"" << Board::squareName(result.move) << "\""
+                  << ", \"score\": " << (positions[i].turn == 'w' ? result.score : -result.score) << "}";
+        firstRun = false;
+    }
+    std::cout << "\n    ], \"nodes\": " << totalNodes
+              << ", \"time_ms\": " << totalMs
+              << ", \"nps\": " << static_cast<size_t>(nodesPerSecond(totalNodes, totalMs)) << "}";
+
+    // one batch against a loop of single searches, same depth and threads
+    std::cerr << "batch\n";
+    std::vector<Board::Position> batchPositions = grandchildren(positions);
+    std::vector<PackedPosition> packed;
+    for (const Board::Position& pos : batchPositions) packed.push_back(PackedPosition::pack(pos));
+
+    BatchAnalyzer analyzer(batchDepth, threads, evaluator);
+    auto start = std::chrono::steady_clock::now();
+    analyzer.analyze(packed);
+    double batchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    OthelloBot bot(batchDepth);
+    bot.toggleAlphaBeta();
+    bot.setThreads(threads);
+    bot.setHashSize(hashMB);
+    bot.setEvaluator(evaluator);
+    bot.setEndgameEmpties(0);
+    bot.setOpeningBook(nullptr);
+    start = std::chrono::steady_clock::now();
+    for (const Board::Position& pos : batchPositions) {
+        Board::State state;
+        Board::fromPosition(state, pos);
+        bot.getBestMove(state);
+    }
+    double loopMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << ",\n    {\"search\": \"batch\", \"depth\": " << batchDepth
+              << ", \"positions\": " << batchPositions.size()
+              << ", \"nodes\": " << analyzer.getNodes()
+              << ", \"time_ms\": " << batchMs
+              << ", \"positions_per_sec\": " << static_cast<size_t>(nodesPerSecond(batchPositions.size(), batchMs))
+              << ", \"loop_time_ms\": " << loopMs
+              << ", \"loop_positions_per_sec\": " << static_cast<size_t>(nodesPerSecond(batchPositions.size(), loopMs)) << "}";
+
+    std::cout << "\n  ]\n}\n";
+    return 0;
+}
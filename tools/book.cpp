@@ -0,0 +1,176 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Opening book builder. Replays game logs (see GameLog.hpp)
+          and collects every position of the first --plies moves,
+          keyed by its smallest symmetric copy, with the results of
+          the games that reached it. Each position's value is then
+          the best of its children's values (negamax over the book),
+          or the mean game result at positions with no child in the
+          book. A position gets an entry when it has a child to play.
+
+          book [--plies N] [--min-games N] [--out FILE] GAMES...
+
+          Positions reached by fewer than --min-games games (default
+          2) are left out. Writes book.bin by default.
+*/
+
+#include "Engine.hpp"
+#include "GameLog.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct BookKeyHash {
+    size_t operator()(const BookKey& key) const {
+        return static_cast<size_t>((key.player * 0x9e3779b97f4a7c15ULL) ^ (key.opponent * 0xc2b2ae3d27d4eb4fULL));
+    }
+};
+
+struct Node {
+    uint32_t games = 0;
+    double total = 0;       // sum of results for the side to move
+    bool valued = false;
+    double value = 0;
+    int bestMove = -1;      // in the key's frame
+};
+
+using NodeMap = std::unordered_map<BookKey, Node, BookKeyHash>;
+
+BookKey bookKey(Board::Bitboard player, Board::Bitboard opponent) {
+    int symmetry;
+    return normalizeBookKey(player, opponent, symmetry);
+}
+
+/*
+    Add the positions of one game. Returns false for an illegal
+    move or a game without a result.
+*/
+bool addGame(const Game& game, int plies, NodeMap& nodes) {
+    Board::Position pos;
+    std::vector<Board::Position> positions;
+    for (int square : game.moves) {
+        if (!pos.legalMoves()) {
+            pos.pass();
+            if (!pos.legalMoves()) return false;
+        }
+        Board::Bitboard flips = pos.flips(square);
+        if (!(pos.empty() & Board::squareBit(square)) || !flips) return false;
+
+        if (static_cast<int>(positions.size()) < plies) positions.push_back(pos);
+        pos.play(square, flips);
+    }
+    if (!pos.isGameOver() && !game.ended) return false;
+
+    int result = pos.finalScore();
+    for (const Board::Position& p : positions) {
+        Node& node = nodes[bookKey(p.player(), p.opponent())];
+        node.games++;
+        node.total += (p.turn == 'w') ? result : -result;
+    }
+    return true;
+}
+
+/*
+    Negamax over the book. Only children reached by at least
+    minGames games count.
+*/
+double value(const BookKey& key, Node& node, NodeMap& nodes, uint32_t minGames) {
+    if (node.valued) return node.value;
+    node.valued = true;
+    node.value = node.total / node.games;
+
+    Board::Bitboard moves = Board::generateMoves(key.player, key.opponent);
+    double best = -1e9;
+    while (moves) {
+        int square = std::countr_zero(moves);
+        moves &= moves - 1;
+        Board::Bitboard flips = Board::computeFlips(square, key.player, key.opponent);
+        Board::Bitboard player = key.player | flips | Board::squareBit(square);
+        Board::Bitboard opponent = key.opponent & ~flips;
+
+        // the opponent may have to pass, then the move is ours again
+        double sign = -1;
+        if (!Board::generateMoves(opponent, player)) {
+            if (!Board::generateMoves(player, opponent)) continue;
+            sign = 1;
+        }
+        else std::swap(player, opponent);
+
+        BookKey childKey = bookKey(player, opponent);
+        auto child = nodes.find(childKey);
+        if (child == nodes.end() || child->second.games < minGames) continue;
+
+        double childValue = sign * value(childKey, child->second, nodes, minGames);
+        if (childValue > best) {
+            best = childValue;
+            node.bestMove = square;
+        }
+    }
+    if (node.bestMove >= 0) node.value = best;
+    return node.value;
+}
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " [--plies N] [--min-games N] [--out FILE] GAMES...\n";
+}
+
+int main(int argc, char** argv) {
+    int plies = 20;
+    uint32_t minGames = 2;
+    std::string outPath = OpeningBook::DEFAULT_BOOK_FILE;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--plies") && hasValue) plies = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--min-games") && hasValue) minGames = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--out") && hasValue) outPath = argv[++i];
+        else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        }
+        else files.push_back(argv[i]);
+    }
+    if (files.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    NodeMap nodes;
+    GameStream stream(files);
+    Game game;
+    size_t games = 0, rejected = 0;
+    while (stream.next(game)) {
+        if (addGame(game, plies, nodes)) games++;
+        else rejected++;
+    }
+
+    std::vector<BookEntry> entries;
+    for (auto& [key, node] : nodes) {
+        if (node.games < minGames) continue;
+        double score = value(key, node, nodes, minGames);
+        if (node.bestMove < 0) continue;
+
+        BookEntry entry;
+        entry.key = key;
+        entry.score = static_cast<int16_t>(std::lround(score));
+        entry.move = static_cast<uint8_t>(node.bestMove);
+        entry.games = node.games;
+        entries.push_back(entry);
+    }
+
+    std::cerr << games << " games, " << rejected << " rejected, " << nodes.size() << " positions, "
+              << entries.size() << " book entries\n";
+    if (!OpeningBook::save(outPath, entries)) {
+        std::cerr << "can't write " << outPath << "\n";
+        return 1;
+    }
+    std::cerr << "wrote " << outPath << "\n";
+    return 0;
+}
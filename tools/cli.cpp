@@ -0,0 +1,185 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Command line engine. Reads one position per line on stdin
+          and writes the best move for each on stdout. No display
+          needed.
+
+          Input:  64 squares in row order ('X' black, 'O' white,
+                  '-' empty), a space, the side to move ('X' or 'O').
+                  Blank lines and lines starting with '#' are skipped.
+          Output: bestmove <square> score <n> depth <n> nodes <n> time <ms> [exact|book]
+                  score is discs for the side to move, "exact" when
+                  the endgame solver proved it, "book" for a move
+                  from the opening book. <square> is
+                  "pass" when only the opponent can move, and the
+                  game is over when it is "none".
+
+          Options: --depth N (default 8), --time MS (per move,
+                   overrides depth), --threads N, --hash MB,
+                   --endgame N (solve exactly at N empties or
+                   fewer, default 14, 0 = off), --eval disc|pattern,
+                   --book FILE|none (default book.bin), --no-alphabeta,
+                   --probcut T (selective search, T standard errors,
+                   parameters from probcut.bin)
+
+          --batch reads every position first and analyzes them all
+          at once with BatchAnalyzer, to --depth on --threads
+          threads: bestmove <square> score <n> depth <n> per line,
+          in input order, with a score after pass and none too.
+          No book, solver or time limit. The total time goes to
+          stderr.
+*/
+
+#include "Engine.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " [--depth N] [--time MS] [--threads N] [--hash MB] [--endgame N] [--eval disc|pattern] [--book FILE|none] [--no-alphabeta] [--probcut T] [--batch]\n";
+}
+
+static int runBatch(int depth, int threads, std::shared_ptr<const Evaluator> evaluator) {
+    // bad lines keep their place in the output
+    std::vector<PackedPosition> positions;
+    std::vector<bool> valid;
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        Board::Position pos;
+        valid.push_back(Board::parsePosition(line, pos));
+        if (valid.back()) positions.push_back(PackedPosition::pack(pos));
+    }
+
+    BatchAnalyzer analyzer(depth, threads, std::move(evaluator));
+    auto start = std::chrono::steady_clock::now();
+    std::vector<BatchAnalyzer::Result> results = analyzer.analyze(positions);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    size_t next = 0;
+    for (bool ok : valid) {
+        if (!ok) {
+            std::cout << "error bad position\n";
+            continue;
+        }
+        Board::Position pos = positions[next].unpack();
+        const BatchAnalyzer::Result& result = results[next++];
+        std::string move = result.move >= 0 ? Board::squareName(result.move) : pos.mustPass() ? "pass" : "none";
+        int score = (pos.turn == 'w') ? result.score : -result.score;
+        std::cout << "bestmove " << move << " score " << score << " depth " << depth << "\n";
+    }
+    std::cerr << positions.size() << " positions, " << analyzer.getNodes() << " nodes, " << elapsed << " ms\n";
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int depth = 8;
+    int timeMs = 0;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int hashMB = 64;
+    int endgameEmpties = EndgameSolver::DEFAULT_EMPTIES;
+    bool alphaBeta = true;
+    bool discEval = false;
+    double probCut = 0.0;
+    bool batch = false;
+    std::string bookPath;
+    
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--depth") && hasValue) depth = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--time") && hasValue) timeMs = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--threads") && hasValue) threads = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--hash") && hasValue) hashMB = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--endgame") && hasValue) endgameEmpties = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--eval") && hasValue) {
+            std::string name = argv[++i];
+            if (name != "disc" && name != "pattern") {
+                std::cerr << "unknown evaluator: " << name << "\n";
+                usage(argv[0]);
+                return 1;
+            }
+            discEval = name == "disc";
+        }
+        else if (!std::strcmp(argv[i], "--book") && hasValue) bookPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--no-alphabeta")) alphaBeta = false;
+        else if (!std::strcmp(argv[i], "--probcut") && hasValue) probCut = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--batch")) batch = true;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if (batch) {
+        std::shared_ptr<const Evaluator> evaluator = PatternEvaluator::defaultInstance();
+        if (discEval) evaluator = std::make_shared<DiscEvaluator>();
+        return runBatch(std::max(1, depth), threads, evaluator);
+    }
+    
+    OthelloBot bot(std::max(1, depth));
+    if (alphaBeta) bot.toggleAlphaBeta();
+    bot.setTimeBudget(timeMs);
+    bot.setThreads(threads);
+    bot.setHashSize(std::max(1, hashMB));
+    bot.setEndgameEmpties(endgameEmpties);
+    bot.setProbCut(probCut);
+    if (discEval) bot.setEvaluator(std::make_shared<DiscEvaluator>());
+    if (bookPath == "none") bot.setOpeningBook(nullptr);
+    else if (!bookPath.empty()) {
+        auto book = std::make_shared<OpeningBook>();
+        if (!book->load(bookPath)) {
+            std::cerr << "bad book file: " << bookPath << "\n";
+            return 1;
+        }
+        bot.setOpeningBook(book);
+    }
+    
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        
+        Board::Position pos;
+        if (!Board::parsePosition(line, pos)) {
+            std::cout << "error bad position" << std::endl;
+            continue;
+        }
+        
+        // no move: either a pass or the end of the game
+        if (pos.isGameOver()) {
+            std::cout << "bestmove none" << std::endl;
+            continue;
+        }
+        if (pos.mustPass()) {
+            std::cout << "bestmove pass" << std::endl;
+            continue;
+        }
+        
+        Board::State state;
+        Board::fromPosition(state, pos);
+        
+        auto start = std::chrono::steady_clock::now();
+        auto [row, col] = bot.getBestMove(state);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        
+        // the bot scores white - black
+        int score = (pos.turn == 'w') ? bot.getLastScore() : -bot.getLastScore();
+        
+        std::cout << "bestmove " << Board::squareName(Board::squareIndex(row, col))
+                  << " score " << score
+                  << " depth " << bot.getCompletedDepth()
+                  << " nodes " << bot.getTreeSize()
+                  << " time " << elapsed
+                  << (bot.isSolved() ? " exact" : "")
+                  << (bot.isBookMove() ? " book" : "") << std::endl;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,342 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Self-play match runner. Plays games between two engine
+          configurations, A and B, on every core and reports
+          win/draw/loss for A, the Elo difference with a 95% error
+          bar and the SPRT state.
+
+          match [--games N] [--a SPEC] [--b SPEC] [--random-moves N]
+                [--threads N] [--seed N] [--sprt ELO0 ELO1] [--log FILE]
+
+          SPEC is a comma separated list of key=value:
+            depth=N, time=MS (per move, overrides depth),
+            eval=disc|pattern, weights=FILE (pattern weights),
+            endgame=N (0 = no solver), hash=MB, alphabeta=0|1,
+            ponder=0|1 (search on the opponent's time),
+            book=FILE|none (default book.bin),
+            probcut=T (selective search, T standard errors, 0 = off),
+            probcut-params=FILE (default probcut.bin)
+          e.g. --a depth=6,eval=pattern --b depth=6,eval=disc
+
+          Openings are --random-moves random legal moves from the
+          start position. Each opening is played twice with the
+          colors swapped, so N is rounded up to an even number.
+          With --sprt the match stops early once the test decides
+          (alpha = beta = 0.05).
+
+          --log writes one line per game, in the order they finish:
+          the moves as a transcript ("f5d6c3...", passes left out),
+          then "# <game> <black> <white> <white - black>". tools/train
+          reads these lines as they are.
+*/
+
+#include "Engine.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct EngineConfig {
+    std::string spec;
+    int depth = 4;
+    int timeMs = 0;
+    int endgameEmpties = EndgameSolver::DEFAULT_EMPTIES;
+    int hashMB = 16;
+    bool alphaBeta = true;
+    bool ponder = false;
+    double probCut = 0.0;
+    std::shared_ptr<const Evaluator> evaluator = PatternEvaluator::defaultInstance();
+    std::shared_ptr<const OpeningBook> book = OpeningBook::defaultInstance();
+    std::shared_ptr<const ProbCut> probCutParams = ProbCut::defaultInstance();
+};
+
+bool parseConfig(const std::string& spec, EngineConfig& config) {
+    config.spec = spec;
+    std::stringstream items(spec);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        if (item.empty()) continue;
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) return false;
+        std::string key = item.substr(0, equals), value = item.substr(equals + 1);
+
+        if (key == "depth") config.depth = std::max(1, std::atoi(value.c_str()));
+        else if (key == "time") config.timeMs = std::atoi(value.c_str());
+        else if (key == "endgame") config.endgameEmpties = std::atoi(value.c_str());
+        else if (key == "hash") config.hashMB = std::max(1, std::atoi(value.c_str()));
+        else if (key == "alphabeta") config.alphaBeta = value != "0";
+        else if (key == "ponder") config.ponder = value != "0";
+        else if (key == "probcut") config.probCut = std::atof(value.c_str());
+        else if (key == "probcut-params") {
+            auto params = std::make_shared<ProbCut>();
+            if (!params->load(value)) {
+                std::cerr << "bad probcut file: " << value << "\n";
+                return false;
+            }
+            config.probCutParams = params;
+        }
+        else if (key == "eval" && value == "disc") config.evaluator = std::make_shared<DiscEvaluator>();
+        else if (key == "eval" && value == "pattern") config.evaluator = PatternEvaluator::defaultInstance();
+        else if (key == "eval") {
+            std::cerr << "unknown evaluator: " << value << "\n";
+            return false;
+        }
+        else if (key == "weights") {
+            auto evaluator = std::make_shared<PatternEvaluator>();
+            if (!evaluator->load(value)) {
+                std::cerr << "bad weight file: " << value << "\n";
+                return false;
+            }
+            config.evaluator = evaluator;
+        }
+        else if (key == "book" && value == "none") config.book = nullptr;
+        else if (key == "book") {
+            auto book = std::make_shared<OpeningBook>();
+            if (!book->load(value)) {
+                std::cerr << "bad book file: " << value << "\n";
+                return false;
+            }
+            config.book = book;
+        }
+        else return false;
+    }
+    return true;
+}
+
+void configure(OthelloBot& bot, const EngineConfig& config) {
+    bot.setDepth(config.depth);
+    if (bot.alphaBetaEnabled() != config.alphaBeta) bot.toggleAlphaBeta();
+    bot.setTimeBudget(config.timeMs);
+    bot.setHashSize(config.hashMB);
+    bot.setEndgameEmpties(config.endgameEmpties);
+    bot.setEvaluator(config.evaluator);
+    bot.setOpeningBook(config.book);
+    bot.setProbCut(config.probCut, config.probCutParams);
+}
+
+/*
+    Opening for a pair of games, the same for every run with the
+    same seed. Stops early if the game ends first.
+*/
+Board::Position randomOpening(uint64_t seed, int pair, int moves, std::string& transcript) {
+    std::mt19937_64 rng(seed ^ (0x9e3779b97f4a7c15ULL * (pair + 1)));
+    Board::Position pos;
+    transcript.clear();
+    for (int i = 0; i < moves; i++) {
+        Board::MoveList list;
+        pos.generateMoves(list);
+        if (list.empty()) {
+            pos.pass();
+            pos.generateMoves(list);
+            if (list.empty()) break;
+        }
+        const Board::Move& move = list[static_cast<int>(rng() % list.size())];
+        transcript += Board::squareName(move.square);
+        pos.makeMove(move);
+    }
+    return pos;
+}
+
+// white - black at the end, empties to the winner
+int playGame(Board::Position pos, OthelloBot& black, OthelloBot& white, bool blackPonders, bool whitePonders,
+             std::string& transcript) {
+    black.clearHash();
+    white.clearHash();
+
+    Board::State state;
+    while (true) {
+        if (!pos.legalMoves()) {
+            pos.pass();
+            if (!pos.legalMoves()) break;
+        }
+        Board::fromPosition(state, pos);
+        OthelloBot& bot = (pos.turn == 'b') ? black : white;
+        auto [row, col] = bot.getBestMove(state);
+
+        int square = Board::squareIndex(row, col);
+        transcript += Board::squareName(square);
+        bool ponders = (pos.turn == 'b') ? blackPonders : whitePonders;
+        pos.play(square, pos.flips(square));
+
+        if (ponders) {
+            Board::fromPosition(state, pos);
+            bot.startPondering(state);
+        }
+    }
+
+    black.stopPondering();
+    white.stopPondering();
+    return pos.finalScore();
+}
+
+struct Tally {
+    int wins = 0, draws = 0, losses = 0;
+
+    int games() const { return wins + draws + losses; }
+    double score() const { return games() ? (wins + 0.5 * draws) / games() : 0.5; }
+
+    // variance of one game's score (1, 0.5 or 0)
+    double variance() const {
+        double s = score();
+        if (!games()) return 0;
+        return (wins * (1 - s) * (1 - s) + draws * (0.5 - s) * (0.5 - s) + losses * s * s) / games();
+    }
+};
+
+double eloFromScore(double score) {
+    score = std::clamp(score, 1e-6, 1 - 1e-6);
+    return 400.0 * std::log10(score / (1.0 - score));
+}
+
+double scoreFromElo(double elo) { return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0)); }
+
+/*
+    Log likelihood ratio of H1 (elo1) against H0 (elo0), with each
+    game's score taken as normal around the expected score
+*/
+double sprtLlr(const Tally& tally, double elo0, double elo1) {
+    double variance = tally.variance();
+    if (variance <= 0) return 0;
+    double s0 = scoreFromElo(elo0), s1 = scoreFromElo(elo1);
+    double total = tally.wins + 0.5 * tally.draws;
+    return (s1 - s0) / variance * (total - tally.games() * (s0 + s1) / 2);
+}
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " [--games N] [--a SPEC] [--b SPEC] [--random-moves N] [--threads N]"
+              << " [--seed N] [--sprt ELO0 ELO1] [--log FILE]\n";
+}
+
+int main(int argc, char** argv) {
+    int games = 100;
+    int randomMoves = 8;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    uint64_t seed = 1;
+    bool sprt = false;
+    double elo0 = 0, elo1 = 5;
+    std::string logPath;
+    EngineConfig configs[2];
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--games") && hasValue) games = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--random-moves") && hasValue) randomMoves = std::max(0, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--threads") && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--seed") && hasValue) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--log") && hasValue) logPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--sprt") && i + 2 < argc) {
+            sprt = true;
+            elo0 = std::atof(argv[++i]);
+            elo1 = std::atof(argv[++i]);
+        }
+        else if ((!std::strcmp(argv[i], "--a") || !std::strcmp(argv[i], "--b")) && hasValue) {
+            EngineConfig& config = configs[argv[i][2] == 'b'];
+            if (!parseConfig(argv[++i], config)) {
+                std::cerr << "bad engine spec: " << argv[i] << "\n";
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::ofstream log;
+    if (!logPath.empty()) {
+        log.open(logPath);
+        if (!log) {
+            std::cerr << "can't write " << logPath << "\n";
+            return 1;
+        }
+    }
+
+    const double lowerBound = std::log(0.05 / 0.95), upperBound = std::log(0.95 / 0.05);
+    int pairs = (games + 1) / 2;
+    std::atomic<int> nextPair = 0;
+    std::atomic<bool> decided = false;
+    std::mutex mutex;
+    Tally tally;
+
+    auto worker = [&] {
+        // one bot per engine, single threaded, reused for every game
+        OthelloBot bots[2];
+        for (int e = 0; e < 2; e++) {
+            configure(bots[e], configs[e]);
+            bots[e].setThreads(1);
+        }
+
+        while (!decided) {
+            int pair = nextPair++;
+            if (pair >= pairs) break;
+
+            std::string opening;
+            Board::Position start = randomOpening(seed, pair, randomMoves, opening);
+
+            // A takes black in the first game of the pair, white in the second
+            for (int game = 0; game < 2; game++) {
+                OthelloBot& black = bots[game];
+                OthelloBot& white = bots[1 - game];
+                std::string transcript = opening;
+                int result = playGame(start, black, white, configs[game].ponder, configs[1 - game].ponder, transcript);
+                int forA = (game == 0) ? -result : result;
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (forA > 0) tally.wins++;
+                else if (forA < 0) tally.losses++;
+                else tally.draws++;
+
+                if (log.is_open()) {
+                    log << transcript << " # " << pair * 2 + game << " "
+                        << (game ? "B" : "A") << " " << (game ? "A" : "B") << " " << result << "\n";
+                }
+
+                double llr = sprt ? sprtLlr(tally, elo0, elo1) : 0;
+                if (sprt && (llr <= lowerBound || llr >= upperBound)) decided = true;
+                std::cerr << "\rgames " << tally.games() << "  +" << tally.wins << " =" << tally.draws
+                          << " -" << tally.losses << std::flush;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < std::min(threads, pairs); t++) workers.emplace_back(worker);
+    worker();
+    for (auto& thread : workers) thread.join();
+    std::cerr << "\n";
+
+    // 95% interval from the normal approximation of the mean score
+    double score = tally.score();
+    double margin = 1.96 * std::sqrt(tally.variance() / std::max(1, tally.games()));
+    double elo = eloFromScore(score);
+    double eloLow = eloFromScore(score - margin), eloHigh = eloFromScore(score + margin);
+
+    std::cout << "A: " << (configs[0].spec.empty() ? "default" : configs[0].spec) << "\n"
+              << "B: " << (configs[1].spec.empty() ? "default" : configs[1].spec) << "\n"
+              << "games " << tally.games() << "  A +" << tally.wins << " =" << tally.draws << " -" << tally.losses
+              << "  score " << score * 100 << "%\n"
+              << "elo " << elo << " +/- " << (eloHigh - eloLow) / 2
+              << " [" << eloLow << ", " << eloHigh << "]\n";
+
+    if (sprt) {
+        double llr = sprtLlr(tally, elo0, elo1);
+        const char* status = llr >= upperBound ? "H1 accepted" : llr <= lowerBound ? "H0 accepted" : "continue";
+        std::cout << "sprt [" << elo0 << ", " << elo1 << "] llr " << llr
+                  << " (" << lowerBound << ", " << upperBound << ") " << status << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,351 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Perft for the move generator. Counts the leaf nodes of the
+          full game tree to a fixed depth. A pass counts as a move,
+          and a finished game is a leaf even before the last ply.
+
+          perft                      check the suite, exit 1 on mismatch
+          perft --depth N [POS]      count to depth N, with nodes/sec
+          perft --divide N [POS]     count under each root move
+          perft --kernels            time the scalar and AVX2 move
+                                     generators against each other
+
+          The start position is checked against published counts,
+          the stored positions against a slow square-by-square
+          reference generator. POS uses the CLI text form. The suite
+          runs on the kernels the CPU supports, --kernels checks that
+          both give the same moves and flips on every position it
+          times.
+*/
+
+#include "Engine.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using Board::Bitboard;
+using Board::Position;
+
+// published counts from the start position, index = depth. Games
+// first end at ply 9, those are counted once as leaves from depth 11.
+constexpr uint64_t START_COUNTS[] = {
+    1, 4, 12, 56, 244, 1396, 8200, 55092, 390216, 3005288, 24571284, 212258800,
+};
+constexpr int START_DEPTH = 11;
+
+// midgame positions, and endgames where a pass comes up within a few plies
+const char* STORED_POSITIONS[] = {
+    "---------O-XOO--OOOOOO----XXXXX----XOXX---O-XOX------O---------- X",
+    "------------X-----O-X-----OXX-----XOOXO--X-OOOOO----OXXO----XXX- X",
+    "------------------XOOO-----OOO---OXOXOOO-X-X-XO--OXX-O-X---X---- X",
+    "O--OXX---O-XXX----XXXX-X-XXOOXO-XXOOOOOOXXX-OOO----XOOO-----OX-O X",
+    "-XOO----OXO-OX-O-XXXXXO--XXXOO-O-XXOO-X--XXXXOXX-O-OOOX----O-O-- X",
+    "-XXXXXXXOOOOOOXO-OXXXXX-X-OXXXX-OOOOOX--O-OX-X--OO-X------------ X",
+    "-O-X-OO--XXXXOXX-XXXOXOX-XXXXXXOXXXXXXXOXXOXXXXOXXXXXX-OOX-X-X-O O",
+    "XXXX--OXXOOOOOOXXOXXOOOOXXOXXOO-XOOOOOOOXOOX-OO-X-OOOOO-XX-O---- X",
+    "-XOOX----XOXXX-X-XXXXXXX-XXOXXXXXXXOOX-XXXOXOOXXXXXXXXXXOOXXOX-- O",
+    "-XXXXXXX--XXXXXX-XXXOXXX-XXOXXXXOXXXXOXX-XXXOOO---XXOOOX--XOOOOO O",
+    "XXX-O---XX-OO---XXOOOOOX-OXOXOOXOOXOOXOXOXOOOOXXOOOOOXXXO-XXXXXX X",
+};
+constexpr int STORED_DEPTH = 6;
+
+uint64_t perft(Position& pos, int depth) {
+    /*
+        Walk the tree with make/undo, the same way the search does.
+        At depth 1 the leaves are counted straight off the move mask.
+    */
+    if (depth == 0) return 1;
+
+    Bitboard moves = pos.legalMoves();
+    if (!moves) {
+        // both sides stuck: the game is over
+        Position other = pos;
+        other.pass();
+        if (!other.legalMoves()) return 1;
+
+        pos.pass();
+        uint64_t nodes = perft(pos, depth - 1);
+        pos.pass();
+        return nodes;
+    }
+
+    if (depth == 1) return std::popcount(moves);
+
+    Board::MoveList list;
+    pos.generateMoves(list);
+    uint64_t nodes = 0;
+    for (const Board::Move& move : list) {
+        pos.makeMove(move);
+        nodes += perft(pos, depth - 1);
+        pos.undoMove(move);
+    }
+    return nodes;
+}
+
+Bitboard referenceFlips(const Position& pos, int square) {
+    /*
+        One square and one direction at a time, no shifts or masks.
+        Slow on purpose, it shares no code with Bitboard.hpp.
+    */
+    Bitboard player = pos.player(), opponent = pos.opponent();
+    if ((player | opponent) & (1ULL << square)) return 0;
+
+    Bitboard flips = 0;
+    int row = square / 8, col = square % 8;
+    for (int dr = -1; dr <= 1; dr++) {
+        for (int dc = -1; dc <= 1; dc++) {
+            if (!dr && !dc) continue;
+            Bitboard run = 0;
+            int r = row + dr, c = col + dc;
+            while (r >= 0 && r < 8 && c >= 0 && c < 8 && (opponent & (1ULL << (r * 8 + c)))) {
+                run |= 1ULL << (r * 8 + c);
+                r += dr;
+                c += dc;
+            }
+            if (run && r >= 0 && r < 8 && c >= 0 && c < 8 && (player & (1ULL << (r * 8 + c))))
+                flips |= run;
+        }
+    }
+    return flips;
+}
+
+uint64_t referencePerft(Position pos, int depth) {
+    /*
+        Same counting rules as perft, built on referenceFlips and
+        copying positions instead of make/undo
+    */
+    if (depth == 0) return 1;
+
+    uint64_t nodes = 0;
+    bool anyMove = false;
+    for (int square = 0; square < 64; square++) {
+        Bitboard flips = referenceFlips(pos, square);
+        if (!flips) continue;
+        anyMove = true;
+        Position next = pos;
+        next.play(square, flips);
+        nodes += referencePerft(next, depth - 1);
+    }
+    if (anyMove) return nodes;
+
+    Position other = pos;
+    other.pass();
+    for (int square = 0; square < 64; square++)
+        if (referenceFlips(other, square))
+            return referencePerft(other, depth - 1);
+    return 1;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void printRate(uint64_t nodes, double seconds) {
+    std::cout << nodes << " nodes in " << seconds << " s";
+    if (seconds > 0) std::cout << " (" << static_cast<uint64_t>(nodes / seconds) << " nodes/sec)";
+    std::cout << "\n";
+}
+
+int divide(Position& pos, int depth) {
+    /*
+        Perft under each root move, so a wrong total can be chased
+        down to the move that causes it
+    */
+    auto start = std::chrono::steady_clock::now();
+    uint64_t total = 0;
+
+    Board::MoveList list;
+    pos.generateMoves(list);
+    if (list.empty()) {
+        total = perft(pos, depth);
+        std::cout << "pass " << total << "\n";
+    }
+    for (const Board::Move& move : list) {
+        pos.makeMove(move);
+        uint64_t nodes = depth > 0 ? perft(pos, depth - 1) : 1;
+        pos.undoMove(move);
+        std::cout << Board::squareName(move.square) << " " << nodes << "\n";
+        total += nodes;
+    }
+
+    std::cout << "total ";
+    printRate(total, secondsSince(start));
+    return 0;
+}
+
+void collect(Position& pos, int depth, std::vector<Position>& positions) {
+    // every position of the tree with a move to play
+    if (!pos.legalMoves()) return;
+    positions.push_back(pos);
+    if (depth == 0) return;
+
+    Board::MoveList list;
+    pos.generateMoves(list);
+    for (const Board::Move& move : list) {
+        pos.makeMove(move);
+        collect(pos, depth - 1, positions);
+        pos.undoMove(move);
+    }
+}
+
+// keeps the timed calls from being optimized away
+volatile Bitboard kernelSink;
+
+template <typename Kernel>
+double nanosPerCall(const std::vector<Position>& positions, const std::vector<Bitboard>& moves, Kernel kernel) {
+    // best of a few passes over every position
+    constexpr int PASSES = 5;
+    double best = 0;
+    uint64_t calls = 0;
+    for (int pass = 0; pass < PASSES; pass++) {
+        Bitboard sum = 0;
+        calls = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < positions.size(); i++) sum += kernel(positions[i], moves[i], calls);
+        double seconds = secondsSince(start);
+        kernelSink = sum;
+        if (pass == 0 || seconds < best) best = seconds;
+    }
+    return calls ? best * 1e9 / calls : 0;
+}
+
+int kernels() {
+    std::vector<Position> positions;
+    Position startPos;
+    collect(startPos, 7, positions);
+    for (const char* text : STORED_POSITIONS) {
+        Position pos;
+        if (Board::parsePosition(text, pos)) collect(pos, 3, positions);
+    }
+    std::vector<Bitboard> moves;
+    for (const Position& pos : positions) moves.push_back(pos.legalMoves());
+    std::cout << positions.size() << " positions\n";
+
+    auto scalarMoves = [](const Position& pos, Bitboard, uint64_t& calls) {
+        calls++;
+        return Board::generateMovesScalar(pos.player(), pos.opponent());
+    };
+    auto scalarFlips = [](const Position& pos, Bitboard moves, uint64_t& calls) {
+        Bitboard sum = 0;
+        for (; moves; moves &= moves - 1, calls++)
+            sum += Board::computeFlipsScalar(std::countr_zero(moves), pos.player(), pos.opponent());
+        return sum;
+    };
+    double movesScalar = nanosPerCall(positions, moves, scalarMoves);
+    double flipsScalar = nanosPerCall(positions, moves, scalarFlips);
+    std::cout << "scalar  moves " << movesScalar << " ns  flips " << flipsScalar << " ns\n";
+
+#if BOARD_AVX2
+    if (!Board::cpuHasAvx2()) {
+        std::cout << "no AVX2 on this CPU\n";
+        return 0;
+    }
+
+    uint64_t mismatches = 0;
+    for (const Position& pos : positions) {
+        Bitboard player = pos.player(), opponent = pos.opponent();
+        mismatches += Board::generateMovesAvx2(player, opponent) != Board::generateMovesScalar(player, opponent);
+        for (Bitboard empty = pos.empty(); empty; empty &= empty - 1) {
+            int square = std::countr_zero(empty);
+            mismatches += Board::computeFlipsAvx2(square, player, opponent) != Board::computeFlipsScalar(square, player, opponent);
+        }
+    }
+
+    auto avx2Moves = [](const Position& pos, Bitboard, uint64_t& calls) {
+        calls++;
+        return Board::generateMovesAvx2(pos.player(), pos.opponent());
+    };
+    auto avx2Flips = [](const Position& pos, Bitboard moves, uint64_t& calls) {
+        Bitboard sum = 0;
+        for (; moves; moves &= moves - 1, calls++)
+            sum += Board::computeFlipsAvx2(std::countr_zero(moves), pos.player(), pos.opponent());
+        return sum;
+    };
+    double movesAvx2 = nanosPerCall(positions, moves, avx2Moves);
+    double flipsAvx2 = nanosPerCall(positions, moves, avx2Flips);
+    std::cout << "avx2    moves " << movesAvx2 << " ns  flips " << flipsAvx2 << " ns\n";
+    std::cout << "speedup moves " << movesScalar / movesAvx2 << "x  flips " << flipsScalar / flipsAvx2 << "x\n";
+    if (mismatches) {
+        std::cout << "FAILED: " << mismatches << " results differ\n";
+        return 1;
+    }
+    std::cout << "kernels agree\n";
+#else
+    std::cout << "no AVX2 kernels in this build\n";
+#endif
+    return 0;
+}
+
+int suite() {
+    int failures = 0;
+    uint64_t total = 0;
+    double seconds = 0;
+
+    Position startPos;
+    for (int depth = 1; depth <= START_DEPTH; depth++) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = perft(startPos, depth);
+        seconds += secondsSince(start);
+        total += nodes;
+        bool ok = nodes == START_COUNTS[depth];
+        failures += !ok;
+        std::cout << "start depth " << depth << ": " << nodes << (ok ? " ok" : " FAIL, expected " + std::to_string(START_COUNTS[depth])) << "\n";
+    }
+
+    for (const char* text : STORED_POSITIONS) {
+        Position pos;
+        if (!Board::parsePosition(text, pos)) {
+            std::cout << "bad stored position: " << text << "\n";
+            failures++;
+            continue;
+        }
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = perft(pos, STORED_DEPTH);
+        seconds += secondsSince(start);
+        uint64_t expected = referencePerft(pos, STORED_DEPTH);
+        total += nodes;
+        bool ok = nodes == expected;
+        failures += !ok;
+        std::cout << text << " depth " << STORED_DEPTH << ": " << nodes << (ok ? " ok" : " FAIL, expected " + std::to_string(expected)) << "\n";
+    }
+
+    // the reference generator is not timed
+    std::cout << (failures ? "FAILED " : "passed ");
+    printRate(total, seconds);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 1) return suite();
+    if (!std::strcmp(argv[1], "--kernels")) return kernels();
+
+    bool isDivide = !std::strcmp(argv[1], "--divide");
+    if ((!isDivide && std::strcmp(argv[1], "--depth")) || argc < 3) {
+        std::cerr << "usage: " << argv[0] << " [--depth N | --divide N] [POSITION] | --kernels\n";
+        return 1;
+    }
+
+    int depth = std::atoi(argv[2]);
+    Position pos;
+    if (argc > 3) {
+        std::string text = argv[3];
+        for (int i = 4; i < argc; i++) text += std::string(" ") + argv[i];
+        if (!Board::parsePosition(text, pos)) {
+            std::cerr << "bad position: " << text << "\n";
+            return 1;
+        }
+    }
+
+    if (isDivide) return divide(pos, depth);
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = perft(pos, depth);
+    printRate(nodes, secondsSince(start));
+    return 0;
+}
@@ -0,0 +1,212 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Multi-ProbCut calibration. Replays game logs (see
+          GameLog.hpp) and searches sampled midgame positions at
+          every depth up to --max-depth with the normal full-width
+          alpha-beta search. For every game phase and depth d it then
+          fits the depth d score against the ProbCut::shallowDepth(d)
+          score: slope a, intercept b and the standard error sigma of
+          what is left.
+
+          probcut [--max-depth N] [--every N] [--max-positions N]
+                  [--threads N] [--min-samples N] [--out FILE] GAMES...
+
+          Every --every-th position of a game (default 4) with more
+          empties than the endgame solver takes is searched, up to
+          --max-positions (default 4000). Fits with fewer than
+          --min-samples positions (default 50) are left out, and
+          those depths keep the defaults. Depths past --max-depth
+          (default 8) get the deepest fit of their phase. Searches
+          use weights.bin like the engine. Writes probcut.bin by
+          default.
+*/
+
+#include "Engine.hpp"
+#include "GameLog.hpp"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Sample {
+    Board::Position pos;
+    int phase = 0;
+    std::array<int, ProbCut::DEPTHS> scores = {};   // for the side to move, by depth
+};
+
+/*
+    Add every --every-th midgame position of one game. Returns false
+    for an illegal move.
+*/
+bool addGame(const Game& game, int every, size_t maxPositions, std::vector<Sample>& samples) {
+    Board::Position pos;
+    int ply = 0;
+    for (int square : game.moves) {
+        if (!pos.legalMoves()) {
+            pos.pass();
+            if (!pos.legalMoves()) return false;
+        }
+        Board::Bitboard flips = pos.flips(square);
+        if (!(pos.empty() & Board::squareBit(square)) || !flips) return false;
+
+        if (ply++ % every == 0 && std::popcount(pos.empty()) > EndgameSolver::DEFAULT_EMPTIES
+            && samples.size() < maxPositions) {
+            Sample sample;
+            sample.pos = pos;
+            sample.phase = Pattern::phase(pos);
+            samples.push_back(sample);
+        }
+        pos.play(square, flips);
+    }
+    return true;
+}
+
+void searchSamples(std::vector<Sample>& samples, std::atomic<size_t>& next, int maxDepth) {
+    OthelloBot bot;
+    bot.toggleAlphaBeta();
+    bot.setEndgameEmpties(0);
+    bot.setOpeningBook(nullptr);
+
+    while (true) {
+        size_t i = next++;
+        if (i >= samples.size()) break;
+        Sample& sample = samples[i];
+
+        // shallow to deep, the table carries over like in a real search
+        bot.clearHash();
+        Board::State state;
+        for (int depth = 1; depth <= maxDepth; depth++) {
+            Board::fromPosition(state, sample.pos);
+            bot.setDepth(depth);
+            bot.getBestMove(state);
+            sample.scores[depth] = (sample.pos.turn == 'w') ? bot.getLastScore() : -bot.getLastScore();
+        }
+        if (i % 100 == 0) std::cerr << "\rsearched " << i << " / " << samples.size() << std::flush;
+    }
+}
+
+/*
+    Least squares fit of deep against shallow scores. Returns false
+    when there are too few samples or no spread to fit.
+*/
+bool fit(const std::vector<Sample>& samples, int phase, int depth, size_t minSamples, ProbCut::Params& params, size_t& count) {
+    int shallow = ProbCut::shallowDepth(depth);
+    double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (const Sample& sample : samples) {
+        if (sample.phase != phase) continue;
+        double x = sample.scores[shallow], y = sample.scores[depth];
+        n++;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    count = static_cast<size_t>(n);
+    if (count < minSamples) return false;
+
+    double varX = sxx / n - (sx / n) * (sx / n);
+    if (varX <= 0) return false;
+    double a = (sxy / n - (sx / n) * (sy / n)) / varX;
+    if (a <= 0) return false;
+    double b = sy / n - a * sx / n;
+
+    double squaredError = 0;
+    for (const Sample& sample : samples) {
+        if (sample.phase != phase) continue;
+        double error = sample.scores[depth] - (a * sample.scores[shallow] + b);
+        squaredError += error * error;
+    }
+    params.a = static_cast<float>(a);
+    params.b = static_cast<float>(b);
+    params.sigma = static_cast<float>(std::max(0.5, std::sqrt(squaredError / n)));
+    return true;
+}
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " [--max-depth N] [--every N] [--max-positions N] [--threads N]"
+              << " [--min-samples N] [--out FILE] GAMES...\n";
+}
+
+int main(int argc, char** argv) {
+    int maxDepth = 8;
+    int every = 4;
+    size_t maxPositions = 4000;
+    size_t minSamples = 50;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::string outPath = ProbCut::DEFAULT_PARAMS_FILE;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--max-depth") && hasValue) maxDepth = std::clamp(std::atoi(argv[++i]), ProbCut::MIN_DEPTH, ProbCut::MAX_DEPTH);
+        else if (!std::strcmp(argv[i], "--every") && hasValue) every = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--max-positions") && hasValue) maxPositions = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--min-samples") && hasValue) minSamples = std::max(3, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--threads") && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--out") && hasValue) outPath = argv[++i];
+        else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        }
+        else files.push_back(argv[i]);
+    }
+    if (files.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Sample> samples;
+    GameStream stream(files);
+    Game game;
+    size_t games = 0, rejected = 0;
+    while (samples.size() < maxPositions && stream.next(game)) {
+        if (addGame(game, every, maxPositions, samples)) games++;
+        else rejected++;
+    }
+    std::cerr << games << " games, " << rejected << " rejected, " << samples.size() << " positions\n";
+    if (samples.empty()) return 1;
+
+    std::atomic<size_t> next = 0;
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; t++)
+        workers.emplace_back([&] { searchSamples(samples, next, maxDepth); });
+    searchSamples(samples, next, maxDepth);
+    for (auto& worker : workers) worker.join();
+    std::cerr << "\rsearched " << samples.size() << " / " << samples.size() << "\n";
+
+    ProbCut probCut;
+    size_t fitted = 0;
+    for (int phase = 0; phase < Pattern::PHASES; phase++) {
+        ProbCut::Params deepest;
+        bool any = false;
+        for (int depth = ProbCut::MIN_DEPTH; depth <= ProbCut::MAX_DEPTH; depth++) {
+            ProbCut::Params params;
+            size_t count = 0;
+            if (depth <= maxDepth && fit(samples, phase, depth, minSamples, params, count)) {
+                probCut.setParams(phase, depth, params);
+                deepest = params;
+                any = true;
+                fitted++;
+                std::printf("phase %2d depth %2d from %d: n %5zu  a %.3f  b %+.2f  sigma %.2f\n",
+                            phase, depth, ProbCut::shallowDepth(depth), count, params.a, params.b, params.sigma);
+            }
+            else if (depth > maxDepth && any) probCut.setParams(phase, depth, deepest);
+        }
+    }
+
+    std::cerr << fitted << " fits\n";
+    if (!probCut.save(outPath)) {
+        std::cerr << "can't write " << outPath << "\n";
+        return 1;
+    }
+    std::cerr << "wrote " << outPath << "\n";
+    return 0;
+}
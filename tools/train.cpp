@@ -0,0 +1,287 @@
+/*
+    Name: Harrison Day
+    Date: 10/16/26
+    Desc: Offline weight training for the pattern evaluator. Replays
+          a game corpus, labels every position with the final disc
+          differential of its game (white - black, empties to the
+          winner) and fits the pattern weights to it by mini-batch
+          SGD. Writes a weight file that PatternEvaluator maps at
+          startup.
+
+          train [--epochs N] [--rate R] [--l2 L] [--batch GAMES]
+                [--threads N] [--solve N] [--init FILE] [--out FILE]
+                GAMES...
+
+          Game files are read by GameStream (see GameLog.hpp), so
+          GUI histories, transcripts and match logs all work. A
+          history with a "Winner:" line is scored as it stands.
+          Other games that don't reach the end are skipped, unless
+          the solver can finish them.
+
+          --solve N labels positions with at most N empties by their
+          exact endgame score instead of the game's result (and lets
+          unfinished games with at most N empties in). Default 0.
+
+          The files are streamed again every epoch, only one batch
+          of games is in memory. Each batch is split between the
+          threads, which replay, label and accumulate gradients on
+          their own; the main thread then applies them. Every
+          position is trained in all 8 symmetries.
+*/
+
+#include "Engine.hpp"
+#include "GameLog.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Options {
+    int epochs = 10;
+    double rate = 0.01;
+    double l2 = 0.0;
+    int batchGames = 256;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int solveEmpties = 0;
+};
+
+/*
+    Gradient of one thread for one batch. Only touched weights are
+    kept in the list, so applying and clearing it is cheap.
+*/
+struct Gradient {
+    std::vector<float> sum;
+    std::vector<uint32_t> hits;
+    std::vector<uint32_t> touched;
+    double squaredError = 0;
+    double absoluteError = 0;
+    size_t positions = 0;
+    size_t games = 0;
+    size_t rejected = 0;
+
+    Gradient() : sum(PatternEvaluator::WEIGHT_COUNT), hits(PatternEvaluator::WEIGHT_COUNT) {}
+
+    void add(uint32_t index, float error) {
+        if (!hits[index]++) touched.push_back(index);
+        sum[index] += error;
+    }
+};
+
+/*
+    Replay one game into positions and labels. Returns false for an
+    illegal move or a game that ends unresolved.
+*/
+bool replay(const Game& game, EndgameSolver& solver, int solveEmpties,
+            std::vector<Board::Position>& positions, std::vector<float>& labels) {
+    positions.clear();
+    labels.clear();
+
+    Board::Position pos;
+    for (int square : game.moves) {
+        if (!pos.legalMoves()) {
+            pos.pass();
+            if (!pos.legalMoves()) return false;
+        }
+        Board::Bitboard flips = pos.flips(square);
+        if (!(pos.empty() & Board::squareBit(square)) || !flips) return false;
+
+        positions.push_back(pos);
+        pos.play(square, flips);
+    }
+
+    int result;
+    if (pos.isGameOver() || game.ended) result = pos.finalScore();
+    else if (std::popcount(pos.empty()) <= solveEmpties) {
+        if (!pos.legalMoves()) pos.pass();
+        int score = solver.solve(pos).score;
+        result = pos.turn == 'w' ? score : -score;
+    } else return false;
+
+    for (const Board::Position& p : positions) {
+        if (std::popcount(p.empty()) <= solveEmpties && p.legalMoves()) {
+            int score = solver.solve(p).score;
+            labels.push_back(static_cast<float>(p.turn == 'w' ? score : -score));
+        } else labels.push_back(static_cast<float>(result));
+    }
+    return true;
+}
+
+void accumulate(const std::vector<Game>& games, size_t begin, size_t end, const std::vector<float>& weights,
+                int solveEmpties, Gradient& gradient) {
+    EndgameSolver solver(solveEmpties > 0 ? 16 : 1);
+    std::vector<Board::Position> positions;
+    std::vector<float> labels;
+
+    for (size_t g = begin; g < end; g++) {
+        if (!replay(games[g], solver, solveEmpties, positions, labels)) {
+            gradient.rejected++;
+            continue;
+        }
+        gradient.games++;
+
+        for (size_t i = 0; i < positions.size(); i++) {
+            // every symmetry has the same label and phase
+            size_t base = static_cast<size_t>(Pattern::phase(positions[i])) * Pattern::PHASE_SIZE;
+
+            for (int s = 0; s < Board::SYMMETRIES; s++) {
+                Board::Position copy;
+                copy.black = Board::symmetry(positions[i].black, s);
+                copy.white = Board::symmetry(positions[i].white, s);
+                int index[Pattern::INSTANCES];
+                Pattern::indices(copy, index);
+
+                float predicted = 0;
+                for (int k = 0; k < Pattern::INSTANCES; k++)
+                    predicted += weights[base + index[k]];
+
+                float error = predicted - labels[i];
+                gradient.squaredError += error * error;
+                gradient.absoluteError += std::abs(error);
+                gradient.positions++;
+                for (int k = 0; k < Pattern::INSTANCES; k++)
+                    gradient.add(static_cast<uint32_t>(base + index[k]), error);
+            }
+        }
+    }
+}
+
+/*
+    Step every touched weight by its mean error over the batch, so
+    rare patterns move as fast as common ones. Clears the gradients.
+*/
+void apply(std::vector<Gradient>& gradients, std::vector<float>& weights, const Options& options) {
+    Gradient& total = gradients[0];
+    for (size_t t = 1; t < gradients.size(); t++) {
+        for (uint32_t index : gradients[t].touched) {
+            if (!total.hits[index]) total.touched.push_back(index);
+            total.hits[index] += gradients[t].hits[index];
+            total.sum[index] += gradients[t].sum[index];
+            gradients[t].hits[index] = 0;
+            gradients[t].sum[index] = 0;
+        }
+        gradients[t].touched.clear();
+    }
+
+    float rate = static_cast<float>(options.rate);
+    float l2 = static_cast<float>(options.l2);
+    for (uint32_t index : total.touched) {
+        float step = total.sum[index] / total.hits[index] + l2 * weights[index];
+        weights[index] -= rate * step;
+        total.hits[index] = 0;
+        total.sum[index] = 0;
+    }
+    total.touched.clear();
+}
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " [--epochs N] [--rate R] [--l2 L] [--batch GAMES] [--threads N]"
+              << " [--solve N] [--init FILE] [--out FILE] GAMES...\n";
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    std::string initPath, outPath = PatternEvaluator::DEFAULT_WEIGHTS_FILE;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--epochs") && hasValue) options.epochs = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--rate") && hasValue) options.rate = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--l2") && hasValue) options.l2 = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--batch") && hasValue) options.batchGames = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--threads") && hasValue) options.threads = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--solve") && hasValue) options.solveEmpties = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--init") && hasValue) initPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--out") && hasValue) outPath = argv[++i];
+        else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        }
+        else files.push_back(argv[i]);
+    }
+    if (files.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // start from the default weights, or carry on from a weight file
+    PatternEvaluator start;
+    if (!initPath.empty() && !start.load(initPath)) {
+        std::cerr << "bad weight file: " << initPath << "\n";
+        return 1;
+    }
+    std::vector<float> weights(PatternEvaluator::WEIGHT_COUNT);
+    for (size_t i = 0; i < weights.size(); i++)
+        weights[i] = static_cast<float>(start.weights()[i]) / PatternEvaluator::WEIGHT_SCALE;
+
+    GameStream stream(files);
+    std::vector<Gradient> gradients(options.threads);
+    std::vector<Game> batch(options.batchGames);
+
+    for (int epoch = 1; epoch <= options.epochs; epoch++) {
+        auto begin = std::chrono::steady_clock::now();
+        stream.rewind();
+        double squaredError = 0, absoluteError = 0;
+        size_t positions = 0, games = 0, rejected = 0;
+
+        while (true) {
+            size_t count = 0;
+            while (count < batch.size() && stream.next(batch[count])) count++;
+            if (!count) break;
+
+            // contiguous slices, one per thread, the caller takes slice 0
+            size_t threads = std::min<size_t>(gradients.size(), count);
+            std::vector<std::thread> workers;
+            for (size_t t = 1; t < threads; t++) {
+                workers.emplace_back([&, t] {
+                    accumulate(batch, count * t / threads, count * (t + 1) / threads, weights,
+                               options.solveEmpties, gradients[t]);
+                });
+            }
+            accumulate(batch, 0, count / threads, weights, options.solveEmpties, gradients[0]);
+            for (auto& worker : workers) worker.join();
+
+            for (Gradient& gradient : gradients) {
+                squaredError += gradient.squaredError;
+                absoluteError += gradient.absoluteError;
+                positions += gradient.positions;
+                games += gradient.games;
+                rejected += gradient.rejected;
+                gradient.squaredError = gradient.absoluteError = 0;
+                gradient.positions = gradient.games = gradient.rejected = 0;
+            }
+            apply(gradients, weights, options);
+        }
+
+        if (!positions) {
+            std::cerr << "no usable games (" << rejected << " rejected)\n";
+            return 1;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cerr << "epoch " << epoch << ": " << games << " games, " << rejected << " rejected, "
+                  << positions << " positions, rmse " << std::sqrt(squaredError / positions)
+                  << " mae " << absoluteError / positions << " discs, " << seconds << " s\n";
+    }
+
+    std::vector<int16_t> packed(weights.size());
+    for (size_t i = 0; i < weights.size(); i++) {
+        float scaled = std::round(weights[i] * PatternEvaluator::WEIGHT_SCALE);
+        packed[i] = static_cast<int16_t>(std::clamp(scaled, -32768.0f, 32767.0f));
+    }
+    if (!PatternEvaluator::save(outPath, packed.data())) {
+        std::cerr << "can't write " << outPath << "\n";
+        return 1;
+    }
+    std::cerr << "wrote " << outPath << "\n";
+    return 0;
+}